@@ -0,0 +1,182 @@
+#ifndef ACTIVITY_HPP_
+#define ACTIVITY_HPP_
+
+/**
+ * @file activity.hpp
+ * @brief Decides which entities are worth updating each frame.
+ *
+ * Entities are binned into fixed-width cells along the x axis. Cells near the
+ * camera or the player are active and tick every frame, cells a bit further
+ * out tick at a lower rate, and everything else sleeps. Only cells that are
+ * awake get looked at, so per-frame cost follows what is near the player
+ * instead of the world's total population.
+ */
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <entityx/entityx.h>
+
+#include <components.hpp>
+#include <events.hpp>
+
+/**
+ * The width of an activity cell, in world units.
+ */
+constexpr const float ACTIVITY_CELL_WIDTH = 256.0f;
+
+/**
+ * How far past the edge of the screen entities stay fully active.
+ */
+constexpr const float ACTIVITY_MARGIN = 256.0f;
+
+/**
+ * How far past the active region entities keep ticking at a lower rate.
+ */
+constexpr const float ACTIVITY_LOW_RATE_MARGIN = 1024.0f;
+
+/**
+ * Low-rate entities are updated once every this many frames.
+ */
+constexpr const unsigned int ACTIVITY_LOW_RATE = 4;
+
+class ActivitySystem : public entityx::System<ActivitySystem>, public entityx::Receiver<ActivitySystem> {
+private:
+	std::mutex mtx;
+
+	std::unordered_map<int, std::vector<entityx::Entity>> cells;
+	std::unordered_map<entityx::Entity::Id, int> cellOf;
+
+	std::vector<entityx::Entity> active;
+	std::vector<entityx::Entity> lowRate;
+
+	// the awake cell ranges used for the current lists
+	int activeStart, activeEnd;
+	int lowStart, lowEnd;
+
+	// set when cell contents change, forcing the lists to be rebuilt
+	bool changed;
+
+	unsigned int frame;
+
+	// the last frame whose position changes have been looked at, and whether
+	// they have to be found with a full sweep instead
+	unsigned int seen;
+	bool sweep;
+
+	// the active world's event manager, which entity events come from
+	entityx::EventManager *worldEvents;
+
+	static inline int cellFor(float x) {
+		return static_cast<int>(std::floor(x / ACTIVITY_CELL_WIDTH));
+	}
+
+	void insert(entityx::Entity e, int cell);
+	void erase(entityx::Entity::Id id);
+	void rebin(entityx::Entity e, float x);
+	void rebuild(void);
+
+	template<typename... Cs>
+	static inline bool hasAll(entityx::Entity e) {
+		bool has[] = { true, e.has_component<Cs>()... };
+		return std::all_of(std::begin(has), std::end(has), [](bool b) { return b; });
+	}
+
+	/**
+	 * Calls f(entity, components...) on each entity that still has the
+	 * components. Callbacks run without the lock held, so they're free to
+	 * create, destroy or move entities.
+	 */
+	template<typename... Cs, typename F>
+	static void call(const std::vector<entityx::Entity>& list, F f) {
+		for (auto e : list) {
+			if (e.valid() && hasAll<Cs...>(e))
+				f(e, *e.component<Cs>().get()...);
+		}
+	}
+
+public:
+	ActivitySystem(void)
+		: activeStart(0), activeEnd(-1), lowStart(0), lowEnd(-1), changed(true), frame(0), seen(0), sweep(true), worldEvents(nullptr) {}
+
+	void configure(entityx::EventManager &ev) override;
+
+	void update(entityx::EntityManager &en, entityx::EventManager &ev, entityx::TimeDelta dt) override;
+
+	void receive(const entityx::ComponentAddedEvent<Position> &cae);
+	void receive(const entityx::ComponentRemovedEvent<Position> &cre);
+	void receive(const entityx::EntityDestroyedEvent &ede);
+	void receive(const WorldActivateEvent &wae);
+
+	/**
+	 * Calls f(entity, dt, components...) on every entity that should tick this
+	 * frame and has all the given components. Low-rate entities only come up
+	 * every ACTIVITY_LOW_RATE frames, with dt scaled to cover the frames they
+	 * skipped.
+	 */
+	template<typename... Cs, typename F>
+	void each(entityx::TimeDelta dt, F f) {
+		std::vector<entityx::Entity> now, slow;
+
+		{
+			std::lock_guard<std::mutex> lock (mtx);
+			now = active;
+			if (frame % ACTIVITY_LOW_RATE == 0)
+				slow = lowRate;
+		}
+
+		call<Cs...>(now, [&f, dt](entityx::Entity e, Cs&... cs) { f(e, dt, cs...); });
+		call<Cs...>(slow, [&f, dt](entityx::Entity e, Cs&... cs) { f(e, dt * ACTIVITY_LOW_RATE, cs...); });
+	}
+
+	/**
+	 * Calls f(entity, components...) on every entity that isn't asleep,
+	 * regardless of its tick rate. Used for drawing.
+	 */
+	template<typename... Cs, typename F>
+	void eachAwake(F f) {
+		std::vector<entityx::Entity> awake;
+
+		{
+			std::lock_guard<std::mutex> lock (mtx);
+			awake.reserve(active.size() + lowRate.size());
+			awake.insert(awake.end(), active.begin(), active.end());
+			awake.insert(awake.end(), lowRate.begin(), lowRate.end());
+		}
+
+		call<Cs...>(awake, f);
+	}
+
+	/**
+	 * Calls f(entity, components...) on every entity in the cells covering
+	 * x0 to x1, whatever they're doing. Entities in the end cells can be a
+	 * little outside the range.
+	 */
+	template<typename... Cs, typename F>
+	void eachIn(float x0, float x1, F f) {
+		std::vector<entityx::Entity> in;
+
+		{
+			std::lock_guard<std::mutex> lock (mtx);
+			for (int c = cellFor(x0), end = cellFor(x1); c <= end; c++) {
+				auto it = cells.find(c);
+				if (it != cells.end())
+					in.insert(in.end(), it->second.begin(), it->second.end());
+			}
+		}
+
+		call<Cs...>(in, f);
+	}
+
+	inline unsigned int getActiveCount(void) const
+	{ return active.size(); }
+
+	inline unsigned int getLowRateCount(void) const
+	{ return lowRate.size(); }
+
+	inline unsigned int getTotalCount(void) const
+	{ return cellOf.size(); }
+};
+
+#endif // ACTIVITY_HPP_
@@ -0,0 +1,106 @@
+#ifndef ATLAS_HPP_
+#define ATLAS_HPP_
+
+/**
+ * @file atlas.hpp
+ * @brief Packs small images into a few large textures.
+ *
+ * Images are placed on pages with a skyline packer as they're first asked
+ * for, so sprites that would each have had their own texture end up sharing
+ * one and can be drawn together. Where everything went is written to a cache
+ * file, which later runs read to put images straight back in place.
+ */
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <common.hpp>
+
+/**
+ * The width and height of an atlas page, in pixels.
+ */
+constexpr const int ATLAS_PAGE_SIZE = 1024;
+
+/**
+ * Images bigger than this (either way) keep a texture of their own.
+ */
+constexpr const int ATLAS_MAX_IMAGE = 256;
+
+/**
+ * The most pages a cached layout may use; a cache asking for more is corrupt.
+ */
+constexpr const unsigned int ATLAS_CACHE_PAGES_MAX = 16;
+
+/**
+ * Empty pixels kept between images, so that they don't bleed into each other.
+ */
+constexpr const int ATLAS_PADDING = 1;
+
+/**
+ * Where the packed layout is kept between runs.
+ */
+constexpr const char *ATLAS_CACHE_FILE = "config/atlas.cache";
+
+/**
+ * Where an image ended up.
+ */
+struct AtlasRegion {
+	GLuint tex;	/**< The texture holding the image */
+	vec2 uv0;	/**< Texture coordinates of the image's first pixel */
+	vec2 uv1;	/**< Texture coordinates just past its last pixel */
+	vec2 size;	/**< The image's dimensions, in pixels */
+};
+
+class TextureAtlas {
+private:
+	struct Rect {
+		unsigned int page;
+		int x, y, w, h;
+		bool uploaded;
+	};
+
+	// a stretch of the skyline: the packed height over [x, x + w)
+	struct Node {
+		int x, y, w;
+	};
+
+	struct Page {
+		GLuint tex;
+		std::vector<Node> skyline;
+	};
+
+	std::vector<Page> pages;
+	std::unordered_map<std::string, Rect> placed;
+	bool cacheLoaded;
+	bool cacheChanged;
+
+	static int fit(const Page& p, size_t i, int w, int h);
+	static void raise(Page& p, const Rect& r);
+
+	Rect pack(int w, int h);
+	Page& getPage(unsigned int i);
+
+	void loadCache(void);
+
+public:
+	TextureAtlas(void)
+		: cacheLoaded(false), cacheChanged(false) {}
+
+	/**
+	 * Gets an image from the atlas, loading and packing it if needed. Only
+	 * call this from the render thread.
+	 */
+	AtlasRegion get(const std::string& path);
+
+	/**
+	 * Writes the layout out, if it changed since it was last read or saved.
+	 */
+	void saveCache(void);
+};
+
+namespace game {
+	extern TextureAtlas atlas;
+}
+
+#endif // ATLAS_HPP_
@@ -0,0 +1,138 @@
+#ifndef COMMANDS_HPP_
+#define COMMANDS_HPP_
+
+/**
+ * @file commands.hpp
+ * @brief Deferred entity changes, for code that runs off the update thread.
+ *
+ * Creating, destroying or assigning to entities while the update thread walks
+ * them is a race. Code running elsewhere records what it wants done in its
+ * thread's command buffer instead, and the engine plays every buffer back at
+ * one sync point in Engine::update(), where nothing else is touching the
+ * entities.
+ */
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <entityx/entityx.h>
+
+struct WorldEntities;
+
+class CommandBuffer {
+private:
+	using Command = std::function<void(entityx::EntityManager&)>;
+
+	/**
+	 * A command and the world that was active when it was recorded. Commands
+	 * are dropped if that world isn't the one being played back into.
+	 */
+	struct Recorded {
+		std::weak_ptr<WorldEntities> world;
+		Command command;
+	};
+
+	/**
+	 * Only contended while the buffer is being played back; each thread
+	 * otherwise has its buffer to itself.
+	 */
+	std::mutex mtx;
+
+	std::vector<Recorded> commands;
+
+	/**
+	 * Commands left behind by threads that exited before they were played.
+	 * Guarded by the same lock as the list of buffers.
+	 */
+	static std::vector<Recorded> orphans;
+
+	void push(Command c);
+
+public:
+	CommandBuffer(void);
+	~CommandBuffer(void);
+
+	/**
+	 * Queues anything else that has to happen at the sync point.
+	 */
+	void run(std::function<void(entityx::EntityManager&)> f) {
+		push(std::move(f));
+	}
+
+	/**
+	 * Queues the creation of an entity. init is called on the new entity as
+	 * part of the same command, so it can assign the entity's components
+	 * before anything else sees it.
+	 */
+	void create(std::function<void(entityx::Entity)> init) {
+		push([init](entityx::EntityManager &en) {
+			init(en.create());
+		});
+	}
+
+	/**
+	 * Queues the destruction of an entity, if it still exists by then.
+	 */
+	void destroy(entityx::Entity::Id id) {
+		push([id](entityx::EntityManager &en) {
+			if (en.valid(id))
+				en.destroy(id);
+		});
+	}
+
+	/**
+	 * Queues a copy of the given component to be assigned to an entity,
+	 * replacing the one it has.
+	 */
+	template<typename C>
+	void assign(entityx::Entity::Id id, C component) {
+		push([id, component](entityx::EntityManager &en) {
+			if (!en.valid(id))
+				return;
+
+			auto e = en.get(id);
+			if (e.has_component<C>())
+				e.remove<C>();
+			e.assign_from_copy<C>(component);
+		});
+	}
+
+	/**
+	 * Queues the removal of a component from an entity, if it has one by then.
+	 */
+	template<typename C>
+	void remove(entityx::Entity::Id id) {
+		push([id](entityx::EntityManager &en) {
+			if (!en.valid(id))
+				return;
+
+			auto e = en.get(id);
+			if (e.has_component<C>())
+				e.remove<C>();
+		});
+	}
+
+	/**
+	 * Runs and clears the queued commands of every thread, each thread's in
+	 * the order they were recorded. Commands recorded against another world
+	 * are dropped.
+	 */
+	static void playAll(entityx::EntityManager &en);
+};
+
+namespace game {
+	/**
+	 * Gets the calling thread's command buffer.
+	 */
+	CommandBuffer& commands(void);
+
+	/**
+	 * Plays back the command buffers of every thread. Only call this from the
+	 * update thread, between system updates.
+	 */
+	void playCommands(entityx::EntityManager &en);
+}
+
+#endif // COMMANDS_HPP_
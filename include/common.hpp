@@ -131,6 +131,36 @@ struct vec3 {
 
 } __attribute__ ((packed));
 
+/**
+ * A view of a contiguous run of objects, so arrays can be handed out without
+ * being copied.
+ */
+template<typename T>
+class Span {
+private:
+	T *first;
+	size_t count;
+
+public:
+	Span(T *f = nullptr, size_t n = 0)
+		: first(f), count(n) {}
+
+	inline T* begin(void) const
+	{ return first; }
+
+	inline T* end(void) const
+	{ return first + count; }
+
+	inline size_t size(void) const
+	{ return count; }
+
+	inline bool empty(void) const
+	{ return count == 0; }
+
+	inline T& operator[](size_t idx) const
+	{ return first[idx]; }
+};
+
 /**
  * This structure contains two sets of coordinates for ray drawing.
  */
@@ -9,9 +9,13 @@
 #ifndef COMPONENTS_HPP
 #define COMPONENTS_HPP
 
+#include <array>
+
 #include <entityx/entityx.h>
 #include <common.hpp>
+#include <events.hpp>
 #include <texture.hpp>
+#include <view.hpp>
 
 /**
  * @struct Position
@@ -86,7 +90,6 @@ struct Solid {
 	 * @param w The desired width of the entity.
 	 * @param h The desired height of the entity.
 	 */
-	Solid(float w = 0.0f, float h = 0.0f): width(w), height(h) {}
 	Solid(float w = 0.0f, float h = 0.0f, vec2 offset = 0.0f): width(w), height(h), offset(offset) {}
 
 	float width; /**< The width of the entity in units */
@@ -94,49 +97,64 @@ struct Solid {
 	vec2 offset; /**< This allows us to make the hitbox in any spot */
 };
 
+/**
+ * @struct SpriteData
+ * @brief One image of a sprite, referenced by its handle in game::sprite_l.
+ */
 struct SpriteData {
-	
-	SpriteData(std::string path, vec2 offset): 
-		offset(offset) {
-			pic = Texture::loadTexture(path);
-			size = Texture::imageDim(path);
-		}
-	
-	GLuint pic;
+	SpriteData(SpriteHandle id = 0, vec2 offset = 0.0f)
+		: id(id), offset(offset) {}
+
+	SpriteData(const std::string& path, vec2 offset)
+		: id(game::sprite_l.loadSprite(path)), offset(offset) {}
+
+	inline SpriteInfo info(void) const
+	{ return game::sprite_l.getSprite(id); }
+
+	SpriteHandle id;
 	vec2 offset;
-	vec2 size;
 };
 
-//TODO
+/**
+ * The most images a single sprite can be made of.
+ */
+constexpr const unsigned int SPRITE_SEGMENTS_MAX = 8;
+
 /**
  * @struct Sprite
  * @brief If an entity is visible we want to be able to see it.
  * Each entity is given a sprite, a sprite can consist of manu frames or pieces to make one.
+ * Segments are stored inline, so sprites never allocate.
  */
 struct Sprite {
+	using Segment = std::pair<SpriteData, vec2>;
+
 	Sprite(bool left = false)
-	 	: faceLeft(left) {}
+	 	: segmentCount(0), faceLeft(left) {}
 
-	std::vector<std::pair<SpriteData, vec2>> getSprite() {
-		return sprite;
+	inline Span<const Segment> getSprite(void) const {
+		return Span<const Segment>(sprite.data(), segmentCount);
 	}
 
 	int clearSprite() {
-		if (sprite.empty())
+		if (segmentCount == 0)
 			return 0;
 
-		sprite.clear();
+		segmentCount = 0;
 		return 1;
 	}
 
 	int addSpriteSegment(SpriteData data, vec2 loc) {
 		//TODO if sprite is in this spot, do something
-		sprite.push_back(std::make_pair(data, loc));
+		if (segmentCount == SPRITE_SEGMENTS_MAX)
+			return 0;
+
+		sprite[segmentCount++] = std::make_pair(data, loc);
 		return 1;
 	}
 
 	int changeSpriteSegment(SpriteData data, vec2 loc) {
-		for (auto &s : sprite) {
+		for (auto &s : Span<Segment>(sprite.data(), segmentCount)) {
 			if (s.second == loc) {
 				s.first = data;
 
@@ -147,7 +165,8 @@ struct Sprite {
 		return 0;
 	}
 
-	std::vector<std::pair<SpriteData, vec2>> sprite;
+	std::array<Segment, SPRITE_SEGMENTS_MAX> sprite;
+	unsigned int segmentCount;
 	bool faceLeft;
 };
 
@@ -178,6 +197,39 @@ struct Visible {
 	float z; /**< The value along the z axis the entity will be drawn on */
 };
 
+/**
+ * @struct CameraTarget
+ * @brief Tags the entity the camera follows.
+ */
+struct CameraTarget {};
+
+/**
+ * @struct Light
+ * @brief Makes an entity light up the world around its position.
+ */
+struct Light {
+	/**
+	 * @param r The light's radius, in world units.
+	 * @param c The light's color, each part from 0 to 1.
+	 */
+	Light(float r = 0.0f, Color c = Color(1.0f, 1.0f, 1.0f, 1.0f)): radius(r), color(c) {}
+
+	float radius; /**< How far the light reaches */
+	Color color;  /**< The color given to what the light reaches */
+};
+
+/**
+ * How far a sprite's images can reach from its entity's position, in world
+ * units. Entities this far off screen are still tested against the view.
+ */
+constexpr const float SPRITE_REACH = 256.0f;
+
+/**
+ * How far off screen sprites are still drawn, since the view is snapped to
+ * whole pixels when it's drawn.
+ */
+constexpr const float SPRITE_CULL_SLACK = 32.0f;
+
 /**
  * SYSTEMS
  */
@@ -188,14 +240,21 @@ public:
 	void update(entityx::EntityManager &en, entityx::EventManager &ev, entityx::TimeDelta dt) override;
 };
 
-class PhysicsSystem : public entityx::System<PhysicsSystem> {
+class PhysicsSystem : public entityx::System<PhysicsSystem>, public entityx::Receiver<PhysicsSystem> {
 private:
+	EntityView<Direction, Physics> bodies;
+
 public:
+	void configure(entityx::EventManager &ev) override;
 	void update(entityx::EntityManager &en, entityx::EventManager &ev, entityx::TimeDelta dt);
+
+	void receive(const WorldActivateEvent &wae);
 };
 class RenderSystem : public entityx::System<RenderSystem> {
-private:
 public:
+	/**
+	 * Records the sprites in view into this frame's render commands.
+	 */
 	void update(entityx::EntityManager &en, entityx::EventManager &ev, entityx::TimeDelta dt) override;
 };
 
@@ -15,6 +15,33 @@ namespace game {
 		extern float VOLUME_SFX;
 
 		extern std::string xmlFolder;
+
+		/**
+		 * A world's component pools get compacted when it's activated if at
+		 * least this fraction of its entity slots are free, and there are at
+		 * least POOL_COMPACT_MIN of them.
+		 */
+		extern float        POOL_COMPACT_RATIO;
+		extern unsigned int POOL_COMPACT_MIN;
+
+		/**
+		 * If set, lights are drawn into a low resolution buffer once a frame
+		 * and the world samples that, instead of shading with each light.
+		 */
+		extern bool LIGHT_BUFFER;
+
+		/**
+		 * What draws the frame's render commands: "gl", or "null" to draw none
+		 * of them.
+		 */
+		extern std::string RENDER_BACKEND;
+
+		/**
+		 * If set, and the GPU can't time passes itself, passes are timed by
+		 * waiting for the GPU to finish around each one. That stalls every
+		 * pass, so it's only for diagnosing.
+		 */
+		extern bool GPU_TIMING_FINISH;
 		
 		void read(void);
 		void update(void);
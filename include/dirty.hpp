@@ -0,0 +1,160 @@
+#ifndef DIRTY_HPP_
+#define DIRTY_HPP_
+
+/**
+ * @file dirty.hpp
+ * @brief Opt-in change tracking for components.
+ *
+ * Systems that write to a tracked component mark the entity with touch() (or
+ * get the component through write(), which does it for them). Consumers can
+ * then walk only the entities that changed since the frame they last ran on,
+ * instead of sweeping every entity in the world.
+ */
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#include <entityx/entityx.h>
+
+#include <gametime.hpp>
+
+/**
+ * How many frames of changes are kept around. A consumer that falls further
+ * behind than this has to do a full sweep.
+ */
+constexpr const unsigned int DIRTY_HISTORY = 64;
+
+namespace game {
+	/**
+	 * The clear() of every component type that has been tracked so far.
+	 */
+	inline std::vector<void (*)(void)>& dirtyTypes(void) {
+		static std::vector<void (*)(void)> types;
+		return types;
+	}
+
+	/**
+	 * Forgets every tracked change of every component type; used when the
+	 * entities being tracked go away, e.g. when another world is activated.
+	 */
+	inline void clearDirty(void) {
+		for (auto clear : dirtyTypes())
+			clear();
+	}
+}
+
+template<typename C>
+class Dirty {
+private:
+	using Change = std::pair<entityx::Entity, unsigned int>;
+
+	/**
+	 * The frame an entity last had its component written. Slots are reused
+	 * when entities are, so the full id says whose write it was.
+	 */
+	struct Version {
+		entityx::Entity::Id id;
+		unsigned int frame;
+	};
+
+	/**
+	 * Each entity's last write, by index.
+	 */
+	static std::vector<Version> versions;
+
+	static inline bool writtenOn(entityx::Entity::Id id, unsigned int frame) {
+		return id.index() < versions.size() && versions[id.index()].id == id
+			&& versions[id.index()].frame == frame;
+	}
+
+	/**
+	 * Changes in the order they happened, one entry per entity per frame.
+	 */
+	static std::deque<Change> changes;
+
+public:
+	/**
+	 * Marks the entity's component as written this frame.
+	 */
+	static void touch(entityx::Entity e) {
+		static bool registered = (game::dirtyTypes().push_back(&Dirty<C>::clear), true);
+		(void)registered;
+
+		auto frame = game::time::getFrameCount();
+		auto index = e.id().index();
+
+		if (writtenOn(e.id(), frame))
+			return;
+
+		if (index >= versions.size())
+			versions.resize(index + 1);
+
+		versions[index] = Version {e.id(), frame};
+		changes.emplace_back(e, frame);
+
+		// forget what is too old to be asked for
+		while (changes.front().second + DIRTY_HISTORY < frame)
+			changes.pop_front();
+	}
+
+	/**
+	 * Checks if the entity's component was written after the given frame.
+	 */
+	static bool changedSince(entityx::Entity e, unsigned int frame) {
+		auto index = e.id().index();
+		return index < versions.size() && versions[index].id == e.id() && versions[index].frame > frame;
+	}
+
+	/**
+	 * Calls f on every live entity whose component was written after the given
+	 * frame, once each. Returns false without calling f if that frame is no
+	 * longer in the history, in which case the caller should do a full sweep.
+	 */
+	template<typename F>
+	static bool each(unsigned int frame, F f) {
+		if (frame + DIRTY_HISTORY < game::time::getFrameCount())
+			return false;
+
+		auto it = std::upper_bound(changes.begin(), changes.end(), frame,
+			[](unsigned int v, const Change& c) { return v < c.second; });
+
+		for (; it != changes.end(); ++it) {
+			auto e = it->first;
+
+			// skip entries superseded by a later write, dead entities, and ones
+			// that have lost the component since
+			if (e.valid() && writtenOn(e.id(), it->second) && e.template has_component<C>())
+				f(e, *e.template component<C>().get());
+		}
+
+		return true;
+	}
+
+	/**
+	 * Forgets every change.
+	 */
+	static void clear(void) {
+		versions.clear();
+		changes.clear();
+	}
+};
+
+template<typename C>
+std::vector<typename Dirty<C>::Version> Dirty<C>::versions;
+
+template<typename C>
+std::deque<typename Dirty<C>::Change> Dirty<C>::changes;
+
+namespace game {
+	/**
+	 * Gets a component for writing, marking it as changed.
+	 */
+	template<typename C>
+	inline C& write(entityx::Entity e) {
+		Dirty<C>::touch(e);
+		return *e.component<C>().get();
+	}
+}
+
+#endif // DIRTY_HPP_
@@ -8,12 +8,53 @@
 #include <components.hpp>
 #include <events.hpp>
 
+#include <memory>
+
 //game::engine::Systems->add<entityx::deps::Dependency<Visible, Sprite>>();
 
+namespace game {
+	extern entityx::EventManager events;
+}
+
+/**
+ * The entities of a single world. Each world has its own entity manager and
+ * its own event manager for entity/component events, so one world can be
+ * built (on another thread, even) without touching the one being simulated.
+ */
+struct WorldEntities {
+	entityx::EventManager events;
+	entityx::EntityManager entities;
+
+	/**
+	 * The entity the camera follows, if the world has one.
+	 */
+	EntityView<CameraTarget> camera;
+
+	WorldEntities(void)
+		: entities(events), camera(entities, events) {}
+};
+
 class Engine : public entityx::Receiver<Engine> {
 private:
 	bool gameRunning;
 
+	/**
+	 * The world the engine starts out with. Systems get configured against it,
+	 * so it's kept around even once other worlds are activated.
+	 */
+	std::shared_ptr<WorldEntities> emptyWorld;
+
+	/**
+	 * The world being simulated; only ever accessed atomically.
+	 */
+	std::shared_ptr<WorldEntities> world;
+
+	template<typename T>
+	inline void updateSystem(entityx::TimeDelta dt) {
+		auto w = getWorld();
+		systems.system<T>()->update(w->entities, game::events, dt);
+	}
+
 public:
     entityx::SystemManager systems;
 
@@ -23,6 +64,17 @@ public:
     void render(entityx::TimeDelta dt);
 	void update(entityx::TimeDelta dt);
 
+	/**
+	 * Makes the given world the one being simulated. This is just a pointer
+	 * swap; systems holding on to world state are told through a
+	 * WorldActivateEvent.
+	 */
+	void activateWorld(std::shared_ptr<WorldEntities> w);
+
+	inline std::shared_ptr<WorldEntities> getWorld(void) const {
+		return std::atomic_load(&world);
+	}
+
 	template<typename T>
 	inline T* getSystem(void) {
 		return dynamic_cast<T*>(systems.system<T>().get());
@@ -43,16 +95,11 @@ public:
 
 
 namespace game {
-	extern entityx::EventManager events;
-    extern entityx::EntityManager entities;
-
     extern Engine engine;
 
     inline void endGame(void) {
         events.emit<GameEndEvent>();
     }
-
-	extern SpriteLoader sprite_l;
 }
 
 
@@ -1,6 +1,21 @@
 #ifndef ENTITIES_HPP_
 #define ENTITIES_HPP_
 
+#include <entityx/entityx.h>
+
 void entityxTest();
 
+/**
+ * Makes a copy of an entity, with all of its components, in the given entity
+ * manager.
+ */
+entityx::Entity copyEntity(entityx::Entity e, entityx::EntityManager &to);
+
+/**
+ * Moves an entity into another entity manager, e.g. the player into the world
+ * they're walking into. The entity is destroyed in its old manager and its
+ * replacement is returned.
+ */
+entityx::Entity moveEntity(entityx::Entity e, entityx::EntityManager &to);
+
 #endif // ENTITIES_HPP_
@@ -10,6 +10,7 @@
 #include <string>
 
 class World;
+struct WorldEntities;
 
 struct MouseScrollEvent {
  	MouseScrollEvent(int sd = 0)
@@ -47,4 +48,11 @@ struct BGMToggleEvent {
 	World *world;
 };
 
+struct WorldActivateEvent {
+    WorldActivateEvent(WorldEntities *w = nullptr)
+        : world(w) {}
+
+    WorldEntities *world;
+};
+
 #endif // EVENTS_HPP_
@@ -11,6 +11,9 @@ namespace game {
         void tick(unsigned int ticks);
         bool tickHasPassed(void);
 
+        unsigned int getFrameCount(void);
+        void nextFrame(void);
+
         void mainLoopHandler(void);
     }
 }
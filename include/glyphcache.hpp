@@ -0,0 +1,189 @@
+#ifndef GLYPHCACHE_HPP_
+#define GLYPHCACHE_HPP_
+
+/**
+ * @file glyphcache.hpp
+ * @brief Renders font glyphs as signed distance fields, as they're needed.
+ *
+ * Glyphs are rendered by FreeType the first time some text uses them, then
+ * turned into distance fields: each texel holds how far it is from the glyph's
+ * outline. Sampled with linear filtering, one field draws the glyph crisply at
+ * any size, so there's only one copy of each glyph whatever sizes are in use.
+ * Fields are packed into shelves on a few texture pages; when the pages fill
+ * up, the least recently used glyphs give up their space.
+ *
+ * Making a field is slow-ish, so they're kept in a cache file between runs.
+ */
+
+#include <cstdint>
+#include <iosfwd>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+#include <common.hpp>
+
+/**
+ * The width and height of a glyph page, in pixels.
+ */
+constexpr const int GLYPH_PAGE_SIZE = 512;
+
+/**
+ * The most pages the cache will make before it starts evicting glyphs.
+ */
+constexpr const unsigned int GLYPH_MAX_PAGES = 4;
+
+/**
+ * The size glyphs are rendered at before they're made into fields.
+ */
+constexpr const unsigned int GLYPH_SDF_SIZE = 32;
+
+/**
+ * How far (in pixels at GLYPH_SDF_SIZE) the fields reach past an outline.
+ * This is also the most an outline or shadow can spread.
+ */
+constexpr const int GLYPH_SDF_SPREAD = 4;
+
+/**
+ * Where fields are kept between runs.
+ */
+constexpr const char *GLYPH_CACHE_FILE = "config/glyphs.cache";
+
+/**
+ * Empty pixels kept around each glyph, so that filtering, and shadows (which
+ * sample up to GLYPH_SDF_SPREAD away), don't pick up its neighbours.
+ */
+constexpr const int GLYPH_PADDING = GLYPH_SDF_SPREAD;
+
+/**
+ * A rendered glyph, and how to place it.
+ */
+struct Glyph {
+	GLuint tex;	/**< The page holding the glyph, 0 if it couldn't be fit */
+	vec2 uv0;	/**< Texture coordinates of the glyph's bottom left */
+	vec2 uv1;	/**< Texture coordinates of its top right */
+	vec2 wh;	/**< The field's dimensions, in pixels */
+	vec2 bl;	/**< Offset from the pen position to the field's top left */
+	vec2 ad;	/**< How far to move the pen after the glyph */
+};
+
+class GlyphCache {
+private:
+	struct Key {
+		FT_Face face;
+		char32_t code;
+
+		bool operator==(const Key& k) const {
+			return face == k.face && code == k.code;
+		}
+	};
+
+	struct KeyHash {
+		size_t operator()(const Key& k) const {
+			return std::hash<void *>()(k.face) ^ (static_cast<size_t>(k.code) * 0x9E3779B1u);
+		}
+	};
+
+	// a field as it's kept in the cache file
+	struct Field {
+		int w, h;
+		vec2 bl, ad;
+		std::vector<uint8_t> data;
+	};
+
+	// a place on a page; once made, a slot only ever changes hands
+	struct Slot {
+		unsigned int page;
+		int x, y, w, h;
+	};
+
+	struct Entry {
+		Glyph glyph;
+		Slot slot;
+		unsigned int lastUsed;
+		std::list<Key>::iterator lru;
+	};
+
+	// a row of slots all as tall as the row
+	struct Shelf {
+		int y, h, x;
+	};
+
+	struct Page {
+		GLuint tex;
+		std::vector<Shelf> shelves;
+		int top;
+	};
+
+	std::unordered_map<Key, Entry, KeyHash> entries;
+	std::list<Key> lru;
+	std::vector<Page> pages;
+	std::vector<Slot> freed;
+
+	// fields from the cache file, by face name and codepoint
+	std::unordered_map<std::string, Field> stored;
+	bool cacheLoaded;
+	bool cacheValid;
+
+	FT_Face lastFace;
+
+	unsigned int frame;
+	unsigned int evictions;
+
+	bool place(int w, int h, Slot& slot);
+	bool evict(int w, int h, Slot& slot);
+	void upload(const Slot& slot, const Field& field);
+
+	bool render(FT_Face face, char32_t code, Field& field);
+	void loadCache(void);
+	void appendCache(const std::string& name, const Field& field);
+	static void writeField(std::ostream& out, const std::string& name, const Field& field);
+
+public:
+	GlyphCache(void)
+		: cacheLoaded(false), cacheValid(false), lastFace(nullptr), frame(0), evictions(0) {}
+
+	/**
+	 * Gets a glyph scaled to the given size, making its field if it isn't
+	 * cached. Only call this from the render thread.
+	 */
+	Glyph get(FT_Face face, unsigned int size, char32_t code);
+
+	/**
+	 * Drops every glyph of the given face, for when it's closed.
+	 */
+	void forget(FT_Face face);
+
+	/**
+	 * Starts a new frame. Glyphs used in the current frame are never evicted,
+	 * since text using them may still be waiting to be drawn.
+	 */
+	inline void nextFrame(void)
+	{ frame++; }
+
+	inline size_t getGlyphCount(void) const
+	{ return entries.size(); }
+
+	inline size_t getPageCount(void) const
+	{ return pages.size(); }
+
+	inline unsigned int getEvictions(void) const
+	{ return evictions; }
+};
+
+namespace game {
+	/**
+	 * Decodes the UTF-8 character starting at s[i], moving i past it. Bad
+	 * sequences decode to U+FFFD; a sequence cut off by the end of the string
+	 * (as typeOut() makes) decodes to nothing, returning 0.
+	 */
+	char32_t nextCodepoint(const std::string& s, size_t& i);
+}
+
+#endif // GLYPHCACHE_HPP_
@@ -0,0 +1,117 @@
+#ifndef GPUTIMER_HPP_
+#define GPUTIMER_HPP_
+
+/**
+ * @file gputimer.hpp
+ * @brief Times how long the GPU spends on each pass of a frame.
+ *
+ * Passes are bracketed by timer queries. Each pass has a query per frame in
+ * flight, and a frame's results are only read once the frame after it has
+ * been issued, by which time they're ready, so reading them never waits on
+ * the GPU. Results go to the profiler, named "gpu " and the pass's name.
+ *
+ * Without timer queries, passes can instead be timed on the CPU by finishing
+ * all GPU work before and after each one. That's only done when asked for,
+ * since it stalls every pass.
+ */
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+/**
+ * How many frames of queries are kept, so results are read a frame late.
+ */
+constexpr const unsigned int GPU_TIMER_FRAMES = 2;
+
+class GPUTimer {
+public:
+	enum Mode {
+		Off,
+		Queries, // timer queries, read a frame late
+		Finish   // glFinish around each pass, read right away
+	};
+
+	/**
+	 * Times a pass for as long as it's around.
+	 */
+	class Scope {
+	private:
+		GPUTimer& timer;
+
+	public:
+		Scope(GPUTimer& t, const char *name)
+			: timer(t) { timer.begin(name); }
+
+		~Scope(void)
+		{ timer.end(); }
+	};
+
+private:
+	struct Pass {
+		const char *name;
+		std::string label; // what the profiler records it as
+		std::array<GLuint, GPU_TIMER_FRAMES> queries;
+		std::array<bool, GPU_TIMER_FRAMES> issued;
+		double last;
+	};
+
+	Mode mode;
+
+	// passes in the order they were first timed
+	std::vector<Pass> passes;
+
+	// the pass being timed, or -1
+	int current;
+
+	// which of the queries this frame uses
+	unsigned int frame;
+
+	std::chrono::steady_clock::time_point start;
+
+	Pass& find(const char *name);
+	void collect(unsigned int slot);
+
+public:
+	GPUTimer(void)
+		: mode(Off), current(-1), frame(0) {}
+
+	/**
+	 * Picks how to time passes, once GL is up.
+	 */
+	void init(void);
+
+	/**
+	 * Starts timing a pass, ending the one before it if it wasn't. Passes
+	 * can't be nested. Names should be string literals.
+	 */
+	void begin(const char *name);
+
+	void end(void);
+
+	/**
+	 * Records the results that are ready and moves on to the next frame's
+	 * queries.
+	 */
+	void endFrame(void);
+
+	/**
+	 * Each pass's name and its last time in milliseconds, as "name 0.00"
+	 * separated by commas.
+	 */
+	std::string getSummary(void) const;
+
+	inline Mode getMode(void) const
+	{ return mode; }
+};
+
+namespace Render {
+	extern GPUTimer gpuTimer;
+}
+
+#define GPU_PASS(name) GPUTimer::Scope gpuPass_ (Render::gpuTimer, name)
+
+#endif // GPUTIMER_HPP_
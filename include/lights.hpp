@@ -0,0 +1,116 @@
+#ifndef LIGHTS_HPP_
+#define LIGHTS_HPP_
+
+/**
+ * @file lights.hpp
+ * @brief Gathers the lights in view, sorting them by the part of screen they touch.
+ *
+ * The screen is split into columns ("tiles"). Each frame, the lights near the
+ * camera are gathered and each one is listed in the tiles its radius reaches.
+ * The lists go up in a small texture, so a fragment only has to look at the
+ * lights listed for its own column instead of every light in view.
+ *
+ * Optionally (see game::config::LIGHT_BUFFER), the lights are instead drawn
+ * into a buffer a quarter of the screen's size once a frame, which the world
+ * then samples; light falls off smoothly, so the smaller size doesn't show.
+ */
+
+#include <array>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <entityx/entityx.h>
+
+#include <common.hpp>
+
+/**
+ * The most lights sent up at once; it's the size of world.frag's light arrays.
+ */
+constexpr const unsigned int LIGHT_MAX = 128;
+
+/**
+ * How many columns the screen is split into.
+ */
+constexpr const unsigned int LIGHT_TILE_COUNT = 32;
+
+/**
+ * The most lights a tile lists; past this, a tile's dimmest lights are left out.
+ */
+constexpr const unsigned int LIGHT_TILE_MAX = 16;
+
+/**
+ * The texture unit the tile lists are bound to.
+ */
+constexpr const GLenum LIGHT_TILE_UNIT = GL_TEXTURE2;
+
+/**
+ * How many times smaller the light buffer is than the screen, each way.
+ */
+constexpr const unsigned int LIGHT_BUFFER_SCALE = 4;
+
+/**
+ * The texture unit the light buffer is bound to.
+ */
+constexpr const GLenum LIGHT_BUFFER_UNIT = GL_TEXTURE3;
+
+class LightSystem : public entityx::System<LightSystem> {
+private:
+	// lights in view, as world.frag takes them
+	std::vector<GLfloat> lights;
+	std::vector<GLfloat> colors;
+
+	// row 0 holds each tile's light count, the rows above it the lights' indices
+	std::array<GLubyte, LIGHT_TILE_COUNT * (LIGHT_TILE_MAX + 1)> tiles;
+	GLuint tileTex;
+
+	float tileOrigin;
+	float tileWidth;
+
+	unsigned int dropped;
+
+	// the light buffer, and the part of the world it covered last frame (none if unused)
+	GLuint bufferFBO;
+	GLuint bufferTex;
+	int bufferWidth, bufferHeight;
+	std::array<GLfloat, 4> bufferView;
+	std::vector<GLfloat> bufferVerts;
+	bool bufferFailed;
+
+	void bin(void);
+	void upload(void);
+
+	bool makeBuffer(void);
+	void drawBuffer(void);
+
+public:
+	LightSystem(void)
+		: tileTex(0), tileOrigin(0), tileWidth(1), dropped(0), bufferFBO(0), bufferTex(0),
+		  bufferWidth(0), bufferHeight(0), bufferView {{0, 0, 0, 0}}, bufferFailed(false) {}
+
+	/**
+	 * Gathers and bins (or draws) the lights around the camera, then sends
+	 * them to the world and grass shaders. Call this on the render thread.
+	 */
+	void update(entityx::EntityManager &en, entityx::EventManager &ev, entityx::TimeDelta dt) override;
+
+	/**
+	 * Lights sent up last frame.
+	 */
+	inline unsigned int getLightCount(void) const
+	{ return lights.size() / 4; }
+
+	/**
+	 * Light listings left out last frame, for going over a limit.
+	 */
+	inline unsigned int getDroppedCount(void) const
+	{ return dropped; }
+
+	/**
+	 * Whether last frame's lights went through the light buffer.
+	 */
+	inline bool isBuffered(void) const
+	{ return bufferView[2] > 0; }
+};
+
+#endif // LIGHTS_HPP_
@@ -31,6 +31,9 @@ public:
     inline void setPlayer(const entityx::Entity& e)
     { pid = e.id(); }
 
+    inline entityx::Entity::Id getPlayerId(void) const
+    { return pid; }
+
     vec2 getPosition(void) const;
 };
 
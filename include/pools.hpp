@@ -0,0 +1,66 @@
+#ifndef POOLS_HPP_
+#define POOLS_HPP_
+
+/**
+ * @file pools.hpp
+ * @brief Accounting and compaction for component storage.
+ *
+ * EntityX stores each component type in a pool indexed by entity index, so a
+ * pool is as big as the highest entity index ever used, whatever is alive now.
+ * Worlds that see a lot of churn end up with pools full of holes; compacting
+ * a world moves its entities down to the lowest indices.
+ */
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <entityx/entityx.h>
+
+struct WorldEntities;
+
+/**
+ * How many components EntityX allocates at a time when a pool grows.
+ */
+constexpr const size_t POOL_CHUNK_SIZE = 8192;
+
+/**
+ * The engine measures the active world's pools every this many frames.
+ */
+constexpr const unsigned int POOL_MEASURE_INTERVAL = 60;
+
+struct PoolStats {
+	std::string name;
+	size_t live;     /**< Components in use */
+	size_t capacity; /**< Slots the pool has, one per entity index */
+	size_t bytes;    /**< Memory taken by the pool's chunks */
+	size_t holes;    /**< Slots with no component in them */
+};
+
+namespace game {
+	namespace pools {
+		/**
+		 * Measures the pools of the given entities, keeping the results for
+		 * getStats(). Walks every entity, so call it now and then, not every
+		 * frame.
+		 */
+		void measure(entityx::EntityManager &en);
+
+		std::vector<PoolStats> getStats(void);
+
+		/**
+		 * Checks the world against the compaction policy.
+		 */
+		bool needsCompaction(entityx::EntityManager &en);
+
+		/**
+		 * Copies a world's entities into a new, densely packed world, in index
+		 * order. If remap is given, it's filled with each entity's new id.
+		 */
+		std::shared_ptr<WorldEntities> compact(WorldEntities &w,
+			std::unordered_map<entityx::Entity::Id, entityx::Entity::Id> *remap = nullptr);
+	}
+}
+
+#endif // POOLS_HPP_
@@ -0,0 +1,57 @@
+#ifndef PROFILER_HPP_
+#define PROFILER_HPP_
+
+/**
+ * @file profiler.hpp
+ * @brief A small profiler for timing parts of the game loop.
+ *
+ * Code gets timed by putting a PROFILE_SCOPE at the top of it. Timings are
+ * kept per name and, together with any sections other parts of the game add
+ * (memory use, counters...), can be dumped to a text file when in debug mode.
+ */
+
+#include <chrono>
+#include <functional>
+#include <ostream>
+#include <string>
+
+namespace game {
+	namespace profiler {
+		/**
+		 * Times its own lifetime, recording it under the given name.
+		 */
+		class Scope {
+		private:
+			const char *name;
+			std::chrono::steady_clock::time_point start;
+
+		public:
+			explicit Scope(const char *n)
+				: name(n), start(std::chrono::steady_clock::now()) {}
+
+			~Scope(void);
+		};
+
+		/**
+		 * Records a timing taken some other way, in milliseconds.
+		 */
+		void record(const char *name, double ms);
+
+		/**
+		 * Gets the last timing recorded under the given name, in milliseconds.
+		 */
+		double getLast(const char *name);
+
+		/**
+		 * Adds a section to the dump; f writes it out.
+		 */
+		void addSection(const std::string& name, std::function<void(std::ostream&)> f);
+
+		void dump(std::ostream& out);
+		bool dump(const std::string& file);
+	}
+}
+
+#define PROFILE_SCOPE(name) game::profiler::Scope profileScope_ (name)
+
+#endif // PROFILER_HPP_
@@ -9,6 +9,58 @@
 #include <common.hpp>
 #include <shader_utils.hpp>
 
+/**
+ * GL calls that change state go through here, which remembers what's been set
+ * and skips calls that wouldn't change anything. Only use these from the
+ * render thread, and don't mix them with the raw calls they stand in for.
+ */
+namespace Render {
+    namespace state {
+        /**
+         * Calls issued and skipped over a frame.
+         */
+        struct Stats {
+            unsigned int issued;
+            unsigned int skipped;
+        };
+
+        void useProgram(GLuint program);
+
+        void activeTexture(GLenum unit);
+        void bindTexture(GLuint tex);
+        void deleteTextures(GLsizei n, const GLuint *tex);
+
+        void enableAttrib(GLint attrib);
+        void disableAttrib(GLint attrib);
+
+        void enable(GLenum cap);
+        void disable(GLenum cap);
+        void depthMask(GLboolean flag);
+
+        /**
+         * Uniform values are remembered per program and location.
+         */
+        void uniform1i(GLint loc, GLint v);
+        void uniform1f(GLint loc, GLfloat v);
+        void uniform2f(GLint loc, GLfloat x, GLfloat y);
+        void uniform3f(GLint loc, GLfloat x, GLfloat y, GLfloat z);
+        void uniform4f(GLint loc, GLfloat x, GLfloat y, GLfloat z, GLfloat w);
+        void uniform4fv(GLint loc, GLsizei count, const GLfloat *v);
+
+        /**
+         * Forgets the state of a program that's being deleted.
+         */
+        void forgetProgram(GLuint program);
+
+        /**
+         * Starts counting a new frame, keeping the last one's counts.
+         */
+        void endFrame(void);
+
+        Stats getLastFrame(void);
+    }
+}
+
 /**
  * @class Shader
  * @brief Handles a texture shader, allowing it's use in the program.
@@ -18,12 +70,14 @@ public:
     GLuint shader;
     GLint  coord;
     GLint  tex;
+    GLint  color; // optional per-vertex color, -1 if the shader has none
     std::vector<GLint> uniform;
 
     void create(const char *vert, const char *frag) {
         shader = create_program(vert, frag);
      	coord  = get_attrib(shader, "coord2d");
      	tex    = get_attrib(shader, "tex_coord");
+     	color  = glGetAttribLocation(shader, "color");
     }
 
     inline void addUniform(const char *name) {
@@ -31,21 +85,21 @@ public:
     }
 
     inline void use(void) {
-        glUseProgram(shader);
+        Render::state::useProgram(shader);
     }
 
     inline void unuse(void) {
-        glUseProgram(0);
+        Render::state::useProgram(0);
     }
 
     inline void enable(void) {
-        glEnableVertexAttribArray(coord);
-        glEnableVertexAttribArray(tex);
+        Render::state::enableAttrib(coord);
+        Render::state::enableAttrib(tex);
     }
 
     inline void disable(void) {
-        glDisableVertexAttribArray(coord);
-        glDisableVertexAttribArray(tex);
+        Render::state::disableAttrib(coord);
+        Render::state::disableAttrib(tex);
     }
 
     ~Shader(void) {
@@ -62,12 +116,39 @@ typedef enum {
     WU_light_impact,
     WU_light,
     WU_light_color,
-    WU_light_size
+    WU_light_size,
+    WU_light_tiles,
+    WU_light_tile_info,
+    WU_light_buffer,
+    WU_light_buffer_view,
+    WU_tex_offset
 } WorldUniform;
 
+typedef enum {
+    GU_grass = WU_light_buffer_view + 1, // the grass shader has no tex_offset
+    GU_grass_size,
+    GU_wind_time
+} GrassUniform;
+
+typedef enum {
+    FU_sampler = 0,
+    FU_ortho,
+    FU_outline_color,
+    FU_outline_width,
+    FU_shadow_color,
+    FU_shadow_offset
+} FontUniform;
+
+typedef enum {
+    LU_view = 0
+} LightUniform;
+
 namespace Render {
     extern Shader worldShader;
+    extern Shader grassShader;
     extern Shader textShader;
+    extern Shader fontShader;
+    extern Shader lightShader;
 
     void initShaders(void);
 
@@ -76,4 +157,66 @@ namespace Render {
     void drawRect(vec2 ll, vec2 ur, float z);
 }
 
+/**
+ * What gets culled against the view, counted separately.
+ */
+typedef enum {
+    CK_sprites = 0,
+    CK_layers,
+    CK_text,
+    CK_count
+} CullKind;
+
+/**
+ * Tests what's about to be drawn against the camera's view, so off screen
+ * things are never submitted. Only use this from the render thread.
+ */
+namespace Render {
+    /**
+     * The part of the world the camera shows, in world units.
+     */
+    struct View {
+        float left, right, bottom, top;
+        float centerX;
+
+        /**
+         * Whether any of the box from loc to loc + size is on screen. Things
+         * with parallax are drawn that much of the way along with the camera.
+         */
+        inline bool sees(vec2 loc, vec2 size, float parallax = 0.0f) const {
+            float x = loc.x + centerX * parallax;
+            return x + size.x >= left && x <= right &&
+                   loc.y + size.y >= bottom && loc.y <= top;
+        }
+    };
+
+    /**
+     * The view at the current offset, widened on each side by margin.
+     */
+    View getView(float margin = 0.0f);
+
+    namespace cull {
+        /**
+         * Things drawn and culled over a frame.
+         */
+        struct Stats {
+            unsigned int drawn;
+            unsigned int culled;
+        };
+
+        /**
+         * Tests a box against the view and counts the result, returning
+         * whether it should be drawn.
+         */
+        bool test(CullKind kind, const View& view, vec2 loc, vec2 size, float parallax = 0.0f);
+
+        /**
+         * Starts counting a new frame, keeping the last one's counts.
+         */
+        void endFrame(void);
+
+        Stats getLastFrame(CullKind kind);
+    }
+}
+
 #endif // RENDER_HPP_
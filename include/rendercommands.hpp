@@ -0,0 +1,211 @@
+#ifndef RENDERCOMMANDS_HPP_
+#define RENDERCOMMANDS_HPP_
+
+/**
+ * @file rendercommands.hpp
+ * @brief Draws recorded as commands over a frame, then handed to a backend.
+ *
+ * Game code records what it wants drawn (sprites, text, meshes, and uniform
+ * changes for them) instead of making GL calls. Each command gets a sort key:
+ * its pass first, then its shader, then its texture and depth, so sorting the
+ * frame's commands groups everything that can be drawn together. Within a
+ * shader, uniforms come first, then meshes, then sprites and text. A backend
+ * takes the sorted frame and draws it; the null backend just counts it, for
+ * running without drawing anything.
+ *
+ * Each thread records into its own list, so recording takes no locks. A
+ * thread hands its list over when it's done with a frame, and the render
+ * thread draws everything handed over so far when it submits.
+ */
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <common.hpp>
+#include <render.hpp>
+#include <spritebatch.hpp>
+
+/**
+ * Passes are drawn in order, each with its own fixed state.
+ */
+typedef enum {
+	RP_world = 0, // depth tested and written
+	RP_text,      // depth tested, not written, since glyphs overlap at their edges
+	RP_count
+} RenderPass;
+
+namespace Render {
+	struct Command {
+		enum Type : uint8_t {
+			DrawSprite,
+			DrawText,
+			DrawMesh,
+			SetUniform
+		};
+
+		uint64_t key;
+		Type type;
+		RenderPass pass;
+		Shader *shader;
+
+		// sprites and text
+		GLuint tex;
+		vec2 uv0, uv1;
+		vec2 loc, size;
+		float z;
+		bool flip;
+		GLubyte color[4];
+
+		// meshes: vertices of x, y, z, s and t in a buffer
+		GLuint vbo;
+		GLint first;
+		GLsizei count;
+
+		// uniforms: which of the shader's, and its first n values
+		unsigned int uniform;
+		unsigned int n;
+		GLfloat value[4];
+	};
+
+	class CommandList {
+	private:
+		std::vector<Command> commands;
+
+		// what's drawn first for a shader, within a pass
+		enum Order : unsigned int {
+			Uniforms = 0,
+			Meshes,
+			Quads
+		};
+
+		static uint64_t makeKey(RenderPass pass, const Shader& shader, Order order, GLuint tex, float z);
+
+		Command& add(Command::Type type, RenderPass pass, Shader& shader);
+
+	public:
+		void drawSprite(RenderPass pass, Shader& shader, GLuint tex, vec2 uv0, vec2 uv1,
+		                vec2 loc, vec2 size, float z, bool flip = false);
+
+		/**
+		 * Text is drawn like sprites, only colored (by shaders that take a color).
+		 */
+		void drawText(RenderPass pass, Shader& shader, GLuint tex, vec2 uv0, vec2 uv1,
+		              vec2 loc, vec2 size, float z, const GLubyte *color);
+
+		/**
+		 * Draws count vertices of a buffer, starting at first, as triangles.
+		 * Meshes are drawn before the pass's sprites with the same shader.
+		 */
+		void drawMesh(RenderPass pass, Shader& shader, GLuint vbo, GLint first, GLsizei count,
+		              GLuint tex, float z);
+
+		/**
+		 * Sets one of the shader's uniforms (by its index in Shader::uniform) for
+		 * everything the shader draws in the pass. Uniforms are set before any of
+		 * the pass's draws with that shader, in the order they're recorded.
+		 * Takes one to four floats; any past the fourth are dropped.
+		 */
+		void setUniform(RenderPass pass, Shader& shader, unsigned int uniform,
+		                const GLfloat *value, unsigned int n);
+
+		void sort(void);
+
+		/**
+		 * Adds another list's commands after this one's.
+		 */
+		inline void append(const CommandList& other)
+		{ commands.insert(commands.end(), other.commands.begin(), other.commands.end()); }
+
+		inline void swap(CommandList& other)
+		{ commands.swap(other.commands); }
+
+		inline void clear(void)
+		{ commands.clear(); }
+
+		inline size_t size(void) const
+		{ return commands.size(); }
+
+		inline std::vector<Command>::const_iterator begin(void) const
+		{ return commands.begin(); }
+
+		inline std::vector<Command>::const_iterator end(void) const
+		{ return commands.end(); }
+	};
+
+	class Backend {
+	public:
+		/**
+		 * What the last frame submitted came to, per pass.
+		 */
+		struct Stats {
+			std::array<unsigned int, RP_count> commands;
+			std::array<unsigned int, RP_count> draws;
+		};
+
+	protected:
+		Stats stats;
+
+	public:
+		Backend(void)
+			: stats {{{0}}, {{0}}} {}
+
+		virtual ~Backend(void) {}
+
+		/**
+		 * Draws a sorted frame. Called on the render thread.
+		 */
+		virtual void submit(const CommandList& list) = 0;
+
+		inline const Stats& getStats(void) const
+		{ return stats; }
+	};
+
+	/**
+	 * Draws with GL, batching runs of sprites and text.
+	 */
+	class GLBackend : public Backend {
+	private:
+		SpriteBatch batch;
+
+		void begin(RenderPass pass, Shader& shader);
+		void end(RenderPass pass, Shader& shader);
+		void drawMesh(const Command& c);
+
+	public:
+		void submit(const CommandList& list) override;
+	};
+
+	/**
+	 * Draws nothing, for running headless.
+	 */
+	class NullBackend : public Backend {
+	public:
+		void submit(const CommandList& list) override;
+	};
+
+	/**
+	 * The calling thread's list, which this frame's commands go into.
+	 */
+	CommandList& commands(void);
+
+	/**
+	 * Hands what the calling thread has recorded over to the next submit.
+	 */
+	void handOverCommands(void);
+
+	/**
+	 * Sorts everything handed over so far, along with what the render thread
+	 * itself recorded, and gives it to the backend. Only call this from the
+	 * render thread.
+	 */
+	void submitCommands(void);
+
+	void setBackend(std::unique_ptr<Backend> b);
+	Backend& getBackend(void);
+}
+
+#endif // RENDERCOMMANDS_HPP_
@@ -0,0 +1,123 @@
+#ifndef SNAPSHOT_HPP_
+#define SNAPSHOT_HPP_
+
+/**
+ * @file snapshot.hpp
+ * @brief Captures the state of the world's entities every tick.
+ *
+ * Component state is packed into a flat binary snapshot. Every so often a
+ * snapshot is kept whole as a keyframe; the ones in between are stored as
+ * their XOR against that keyframe, which is mostly zeros and run-length
+ * encodes down to very little. The most recent snapshots are kept in a ring
+ * that never grows past SNAPSHOT_BUDGET bytes, and any of them can be put
+ * back, e.g. to rewind the last few seconds while debugging.
+ */
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <entityx/entityx.h>
+
+#include <events.hpp>
+
+/**
+ * The most memory, in bytes, the snapshot ring may take up.
+ */
+constexpr const size_t SNAPSHOT_BUDGET = 4 * 1024 * 1024;
+
+/**
+ * Every this many snapshots one is kept whole, for the next ones to be
+ * stored against.
+ */
+constexpr const unsigned int SNAPSHOT_KEYFRAME_INTERVAL = 64;
+
+/**
+ * The largest a snapshot may decode to; anything claiming more is corrupt.
+ */
+constexpr const size_t SNAPSHOT_RAW_MAX = 64 * 1024 * 1024;
+
+/**
+ * How many ticks the debug rewind key goes back.
+ */
+constexpr const unsigned int SNAPSHOT_REWIND_TICKS = 100;
+
+class SnapshotSystem : public entityx::System<SnapshotSystem>, public entityx::Receiver<SnapshotSystem> {
+private:
+	struct Entry {
+		bool keyframe;
+		std::vector<uint8_t> data; /**< RLE-encoded snapshot, or its XOR against the keyframe */
+	};
+
+	/**
+	 * Saved entity ids that had to be given new ones when restored.
+	 */
+	using Remap = std::unordered_map<entityx::Entity::Id, entityx::Entity::Id>;
+
+	std::mutex mtx;
+
+	std::deque<Entry> ring;
+	size_t bytes;
+
+	// the unencoded keyframe new entries get stored against
+	std::vector<uint8_t> keyframe;
+	unsigned int sinceKeyframe;
+
+	// the tick the last snapshot was taken on
+	unsigned int lastTick;
+
+	static std::vector<uint8_t> encode(const std::vector<uint8_t>& raw);
+	static std::vector<uint8_t> decode(const std::vector<uint8_t>& data);
+
+	void push(Entry e);
+
+	/**
+	 * Points the player system at the player's new id, or at the camera's
+	 * target if the player didn't make it.
+	 */
+	static void remapPlayer(const Remap& remap, entityx::EntityManager &en);
+
+public:
+	SnapshotSystem(void)
+		: bytes(0), sinceKeyframe(SNAPSHOT_KEYFRAME_INTERVAL), lastTick(~0u) {}
+
+	void configure(entityx::EventManager &ev) override;
+	void update(entityx::EntityManager &en, entityx::EventManager &ev, entityx::TimeDelta dt) override;
+
+	void receive(const WorldActivateEvent &wae);
+
+	/**
+	 * Packs the state of every entity into a snapshot.
+	 */
+	static std::vector<uint8_t> serialize(entityx::EntityManager &en);
+
+	/**
+	 * Puts the entities back the way the snapshot has them. Entities that
+	 * weren't around then are destroyed, ones that have gone since are made
+	 * again (with new ids), which are returned by the ids they were saved as.
+	 */
+	static Remap deserialize(const std::vector<uint8_t>& raw, entityx::EntityManager &en);
+
+	/**
+	 * Restores the snapshot taken the given number of ticks ago, dropping the
+	 * ones after it. Returns false if the ring doesn't go back that far.
+	 */
+	bool restore(unsigned int ticksAgo, entityx::EntityManager &en);
+
+	/**
+	 * Writes the entities' current state to a file, or reads it back.
+	 */
+	static bool save(const std::string& file, entityx::EntityManager &en);
+	static bool load(const std::string& file, entityx::EntityManager &en);
+
+	inline size_t getCount(void) const
+	{ return ring.size(); }
+
+	inline size_t getBytes(void) const
+	{ return bytes + keyframe.size(); }
+};
+
+#endif // SNAPSHOT_HPP_
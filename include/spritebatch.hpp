@@ -0,0 +1,74 @@
+#ifndef SPRITEBATCH_HPP_
+#define SPRITEBATCH_HPP_
+
+/**
+ * @file spritebatch.hpp
+ * @brief Draws many textured quads with as few draw calls as possible.
+ *
+ * Sprites are queued up over a frame, then sorted by texture (and by depth
+ * within a texture) and written as interleaved vertices straight into the
+ * stream buffer. Each run of sprites sharing a texture is a single draw.
+ */
+
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <common.hpp>
+#include <render.hpp>
+
+class SpriteBatch {
+private:
+	struct Vertex {
+		GLfloat x, y, z;
+		GLfloat u, v;
+		GLubyte r, g, b, a;
+	};
+
+	struct Quad {
+		GLuint tex;
+		float z;
+		Vertex verts[6];
+	};
+
+	std::vector<Quad> quads;
+
+	GLubyte color[4];
+
+	unsigned int drawCount;
+	unsigned int spriteCount;
+
+public:
+	SpriteBatch(void)
+		: color {255, 255, 255, 255}, drawCount(0), spriteCount(0) {}
+
+	/**
+	 * Queues a sprite, its lower-left corner at loc, showing [uv0, uv1] of the
+	 * texture. Left-facing sprites get their texture coordinates mirrored.
+	 */
+	void add(GLuint tex, vec2 uv0, vec2 uv1, vec2 loc, vec2 size, float z, bool flip = false);
+
+	/**
+	 * Sets the color given to sprites queued from now on. It's only used by
+	 * shaders that take a color attribute.
+	 */
+	inline void setColor(GLubyte r, GLubyte g, GLubyte b, GLubyte a = 255)
+	{ color[0] = r, color[1] = g, color[2] = b, color[3] = a; }
+
+	/**
+	 * Draws everything queued with the given shader, which should already be
+	 * in use, then empties the batch.
+	 */
+	void flush(Shader& shader);
+
+	/**
+	 * Draw calls and sprites in the last flush.
+	 */
+	inline unsigned int getDrawCount(void) const
+	{ return drawCount; }
+
+	inline unsigned int getSpriteCount(void) const
+	{ return spriteCount; }
+};
+
+#endif // SPRITEBATCH_HPP_
@@ -0,0 +1,100 @@
+#ifndef STREAMBUFFER_HPP_
+#define STREAMBUFFER_HPP_
+
+/**
+ * @file streambuffer.hpp
+ * @brief One big vertex buffer that everything drawn from the CPU streams through.
+ *
+ * Geometry that changes every frame is written one piece after another into a
+ * ring. Writes only ever go past what's been drawn from since the buffer was
+ * last orphaned, so where glMapBufferRange is around they're mapped
+ * unsynchronized and written straight into the driver's memory, with no
+ * waiting and no extra copies. When the ring runs out, its storage is
+ * orphaned (the driver hands over fresh storage, keeping the old until the GPU
+ * is done with it) and writing starts over from the front.
+ */
+
+#include <vector>
+
+#include <GL/glew.h>
+
+#include <render.hpp>
+
+/**
+ * The size of the ring, in bytes. It grows if a single write needs more.
+ */
+constexpr const size_t STREAM_BUFFER_SIZE = 4 * 1024 * 1024;
+
+class StreamBuffer {
+public:
+	/**
+	 * Counts over a frame.
+	 */
+	struct Stats {
+		unsigned int writes;
+		unsigned int orphans;
+		size_t bytes;
+	};
+
+private:
+	GLuint vbo;
+	size_t size;
+	size_t head;
+
+	// where glMapBufferRange isn't, or fails, writes are staged and copied up
+	bool mapRange;
+	bool staged;
+	std::vector<unsigned char> staging;
+
+	GLintptr writeOffset;
+	size_t writeBytes;
+
+	Stats frame;
+	Stats lastFrame;
+
+public:
+	StreamBuffer(void)
+		: vbo(0), size(0), head(0), mapRange(false), staged(false), writeOffset(0), writeBytes(0),
+		  frame {0, 0, 0}, lastFrame {0, 0, 0} {}
+
+	/**
+	 * Makes room for the given number of bytes and returns where to write
+	 * them; the buffer is left bound to GL_ARRAY_BUFFER. Nothing else may be
+	 * written until unmap() is called.
+	 */
+	void *map(size_t bytes);
+
+	/**
+	 * Finishes a write, returning its offset into the buffer.
+	 */
+	GLintptr unmap(void);
+
+	/**
+	 * Copies data into the ring, returning its offset.
+	 */
+	GLintptr push(const void *data, size_t bytes);
+
+	/**
+	 * Starts counting a new frame, keeping the last one's counts.
+	 */
+	void endFrame(void);
+
+	inline const Stats& getLastFrame(void) const
+	{ return lastFrame; }
+};
+
+namespace Render {
+	extern StreamBuffer stream;
+
+	/**
+	 * Streams a draw's vertices and points the shader's coord and tex
+	 * attributes at them, in place of passing the arrays to
+	 * glVertexAttribPointer. With a stride (in bytes), coords and tex point
+	 * into the same interleaved array; without one, they're separate and
+	 * tightly packed.
+	 */
+	void streamVertices(Shader& s, GLsizei count, const GLfloat *coords, const GLfloat *tex,
+	                    GLsizei stride = 0);
+}
+
+#endif // STREAMBUFFER_HPP_
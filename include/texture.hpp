@@ -8,6 +8,10 @@
 #define TEXTURE_H
 
 #include <common.hpp>
+#include <atlas.hpp>
+#include <render.hpp>
+
+#include <mutex>
 
 /**
  * When defined, DEBUG allows extra messages to be printed to the terminal for
@@ -26,6 +30,11 @@ namespace Texture {
 	 */
 
 	GLuint loadTexture(std::string fileName);
+
+	/**
+	 * Returns a 1x1 texture of the given color (each part 0-255). Textures
+	 * are kept by color, so calling this every frame is fine.
+	 */
     GLuint genColor(Color c);
 
 	void freeTextures(void);
@@ -35,42 +44,90 @@ namespace Texture {
 	vec2 imageDim(std::string fileName);
 }
 
+/**
+ * A small handle to a sprite image interned in the SpriteLoader.
+ */
+using SpriteHandle = uint16_t;
+
+/**
+ * What the renderer needs to know about a sprite image.
+ */
+struct SpriteInfo {
+	GLuint tex;	/**< The GL texture holding the image */
+	vec2 uv0;	/**< Where the image starts in that texture */
+	vec2 uv1;	/**< Where it ends */
+	vec2 size;	/**< The image's dimensions, in pixels */
+};
+
+/**
+ * Interns sprite images so that each one is only looked up once. Components
+ * refer to images by handle, which makes them cheap to create and copy.
+ *
+ * Handles can be made from any thread (worlds get built in the background);
+ * the image itself is only put in the atlas the first time it's drawn.
+ */
 class SpriteLoader {
 private:
-	std::unordered_map<uint64_t, GLuint> sprites;
-	std::unordered_map<std::string, uint64_t> spritesLoc;
-
-	uint64_t freeID = 0;
-	uint64_t increaseID() {
-		uint64_t id_t = 0;
-		while (1) {
-			try {
-				sprites.at(id_t);
-			} catch (const std::out_of_range& oor) {
-				freeID = id_t;
-				return freeID;
-			}
-			id_t++;
-		}
-	}
+	std::mutex mtx;
+
+	std::vector<SpriteInfo> sprites;
+	std::vector<std::string> paths;
+
+	// whether each sprite's image has been looked for; one that couldn't be
+	// loaded keeps a zero texture, and isn't looked for again
+	std::vector<bool> loaded;
+	std::unordered_map<std::string, SpriteHandle> spritesLoc;
+
 public:
-	uint64_t loadSprite(std::string s)	{
-		uint64_t tex_e = 0;
-		try {
-			tex_e = spritesLoc.at(s);
-		} catch (const std::out_of_range& oor) {
-			sprites.emplace(increaseID(), Texture::loadTexture (s));
-			spritesLoc.emplace(s, freeID);
-			return freeID;
-		}
-		return tex_e;
+	SpriteHandle loadSprite(const std::string& s) {
+		std::lock_guard<std::mutex> lock (mtx);
+
+		auto found = spritesLoc.find(s);
+		if (found != spritesLoc.end())
+			return found->second;
+
+		SpriteHandle id = sprites.size();
+		sprites.push_back(SpriteInfo {0, vec2(0, 0), vec2(1, 1), vec2(0, 0)});
+		paths.push_back(s);
+		loaded.push_back(false);
+		spritesLoc.emplace(s, id);
+		return id;
+	}
+
+	/**
+	 * Gets the path a sprite was loaded from.
+	 */
+	std::string getPath(SpriteHandle id) {
+		std::lock_guard<std::mutex> lock (mtx);
+		return (id < paths.size()) ? paths[id] : std::string();
 	}
 
-	GLuint getSprite(uint64_t id) {
-		return sprites.at(id);
+	/**
+	 * Gets a sprite's texture and size, loading it if needed. Handles that
+	 * weren't given out get an empty sprite. Only call this from the render
+	 * thread.
+	 */
+	SpriteInfo getSprite(SpriteHandle id) {
+		std::lock_guard<std::mutex> lock (mtx);
+
+		if (id >= sprites.size())
+			return SpriteInfo {0, vec2(0, 0), vec2(0, 0), vec2(0, 0)};
+
+		auto& info = sprites[id];
+		if (!loaded[id]) {
+			auto region = game::atlas.get(paths[id]);
+			info = SpriteInfo {region.tex, region.uv0, region.uv1, region.size};
+			loaded[id] = true;
+		}
+
+		return info;
 	}
 };
 
+namespace game {
+	extern SpriteLoader sprite_l;
+}
+
 /**
  * DRAFT texture iterator?
  */
@@ -93,13 +150,13 @@ public:
 	}
 	void operator++(int) noexcept {
 		if (++position < std::end(textures))
-			glBindTexture(GL_TEXTURE_2D, (*position).first);
+			Render::state::bindTexture((*position).first);
 		else
 			position = std::end(textures) - 1;
 	}
 	void operator--(int) noexcept {
 		if (--position >= std::begin(textures))
-			glBindTexture(GL_TEXTURE_2D, (*position).first);
+			Render::state::bindTexture((*position).first);
 		else
 			position = std::begin(textures);
 	}
@@ -108,7 +165,7 @@ public:
 			throw std::invalid_argument("texture index out of range");
 
 		position = std::begin(textures) + index;
-		glBindTexture(GL_TEXTURE_2D, (*position).first);
+		Render::state::bindTexture((*position).first);
 	}
 	const std::string& getTexturePath(const int &index) {
 		if (index < 0 || index > static_cast<int>(textures.size()))
@@ -116,6 +173,9 @@ public:
 
 		return textures[index].second;
 	}
+	GLuint getTexture(void) const {
+		return (position != std::end(textures)) ? (*position).first : 0;
+	}
 	const vec2 getTextureDim(void) {
 		return Texture::imageDim((*position).second);
 	}
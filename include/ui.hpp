@@ -94,6 +94,13 @@ namespace ui {
 	void setFontColor(unsigned char r,unsigned char g,unsigned char b, unsigned char a);
 	void setFontZ(float z);
 
+	/*
+	 *	Sets an outline or drop shadow for all text; an alpha of 0 turns them off.
+	*/
+
+	void setFontOutline(unsigned char r, unsigned char g, unsigned char b, unsigned char a, float width);
+	void setFontShadow(unsigned char r, unsigned char g, unsigned char b, unsigned char a, vec2 offset);
+
 	/*
 	 *	Draw a centered string.
 	*/
@@ -112,6 +119,13 @@ namespace ui {
 	 */
 	void putTextL(vec2 c,const char *str, ...);
 
+	/**
+	 * Draws all text put since the last flush, along with everything else
+	 * recorded into the frame's render commands. This must be called once a
+	 * frame, after everything else that puts text.
+	 */
+	void flushText(void);
+
 	/*
 	 *	Creates a dialogBox text string (format: `name`: `text`). This function simply sets up
 	 *	variables that are drawn in ui::draw(). When the dialog box exists player control is
@@ -0,0 +1,146 @@
+#ifndef VIEW_HPP_
+#define VIEW_HPP_
+
+/**
+ * @file view.hpp
+ * @brief Cached lists of the entities that have a set of components.
+ *
+ * EntityManager::each() checks the component mask of every entity slot each
+ * time it's called. An EntityView does that once, then keeps itself up to
+ * date from the component added/removed and entity destroyed events, so
+ * iterating it only touches entities that match.
+ */
+
+#include <unordered_map>
+#include <vector>
+
+#include <entityx/entityx.h>
+
+#include <common.hpp>
+
+template<typename... Cs>
+class EntityView : public entityx::Receiver<EntityView<Cs...>> {
+private:
+	std::vector<entityx::Entity> entities;
+	std::unordered_map<entityx::Entity::Id, size_t> where;
+
+	static inline bool matches(entityx::Entity e) {
+		bool has[] = { true, e.has_component<Cs>()... };
+		return std::all_of(std::begin(has), std::end(has), [](bool b) { return b; });
+	}
+
+	void add(entityx::Entity e) {
+		if (where.count(e.id()) || !matches(e))
+			return;
+
+		where.emplace(e.id(), entities.size());
+		entities.push_back(e);
+	}
+
+	void remove(entityx::Entity::Id id) {
+		auto it = where.find(id);
+		if (it == where.end())
+			return;
+
+		// keep the list dense by moving the last entity into the hole
+		auto last = entities.back();
+		entities[it->second] = last;
+		where[last.id()] = it->second;
+
+		entities.pop_back();
+		where.erase(id);
+	}
+
+	// the event manager we're subscribed to, if any
+	entityx::EventManager *events;
+
+public:
+	EntityView(void)
+		: events(nullptr) {}
+
+	EntityView(entityx::EntityManager &en, entityx::EventManager &ev)
+		: events(nullptr) {
+		bind(en, ev);
+	}
+
+	~EntityView(void) {
+		unbind();
+	}
+
+	/**
+	 * Points the view at another set of entities, rescanning it.
+	 */
+	void bind(entityx::EntityManager &en, entityx::EventManager &ev) {
+		unbind();
+
+		en.each<Cs...>([this](entityx::Entity e, Cs&...) { add(e); });
+
+		int subscribe[] = {
+			0,
+			(ev.subscribe<entityx::ComponentAddedEvent<Cs>>(*this), 0)...,
+			(ev.subscribe<entityx::ComponentRemovedEvent<Cs>>(*this), 0)...
+		};
+		(void)subscribe;
+
+		ev.subscribe<entityx::EntityDestroyedEvent>(*this);
+		events = &ev;
+	}
+
+	/**
+	 * Empties the view and stops listening for changes.
+	 */
+	void unbind(void) {
+		if (events == nullptr)
+			return;
+
+		int unsubscribe[] = {
+			0,
+			(events->unsubscribe<entityx::ComponentAddedEvent<Cs>>(*this), 0)...,
+			(events->unsubscribe<entityx::ComponentRemovedEvent<Cs>>(*this), 0)...
+		};
+		(void)unsubscribe;
+
+		events->unsubscribe<entityx::EntityDestroyedEvent>(*this);
+		events = nullptr;
+
+		entities.clear();
+		where.clear();
+	}
+
+	template<typename C>
+	void receive(const entityx::ComponentAddedEvent<C> &cae) {
+		add(cae.entity);
+	}
+
+	template<typename C>
+	void receive(const entityx::ComponentRemovedEvent<C> &cre) {
+		remove(cre.entity.id());
+	}
+
+	void receive(const entityx::EntityDestroyedEvent &ede) {
+		remove(ede.entity.id());
+	}
+
+	/**
+	 * Calls f(entity, components...) on every entity in the view.
+	 */
+	template<typename F>
+	void each(F f) {
+		for (auto e : entities)
+			f(e, *e.template component<Cs>().get()...);
+	}
+
+	inline Span<const entityx::Entity> get(void) const
+	{ return Span<const entityx::Entity>(entities.data(), entities.size()); }
+
+	inline size_t size(void) const
+	{ return entities.size(); }
+
+	inline bool empty(void) const
+	{ return entities.empty(); }
+
+	inline entityx::Entity front(void) const
+	{ return entities.front(); }
+};
+
+#endif // VIEW_HPP_
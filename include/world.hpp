@@ -15,6 +15,12 @@
 #include <components.hpp>
 using namespace tinyxml2;
 
+#include <array>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
 /**
  * The background type enum.
  * This enum contains all different possibilities for world backgrounds; used
@@ -95,7 +101,17 @@ constexpr const char* WorldWeatherString[3] = {
 	"Snowy"
 };
 
+struct WorldEntities;
+
+/**
+ * How many parallax layers a world style has, the mountains included.
+ */
+constexpr const unsigned int WORLD_LAYER_COUNT = 5;
+
 struct WorldData2 {
+	// the file this world was built from
+	std::string xmlFile;
+
 	// data
 	std::vector<WorldData> data;
 	float startX;
@@ -103,7 +119,7 @@ struct WorldData2 {
 	// indoor
 	bool indoor;
 	float indoorWidth;
-	GLuint indoorTex;
+	std::string indoorTexPath;
 
 	// links
 	std::string toLeft, toRight;
@@ -118,23 +134,101 @@ struct WorldData2 {
 
 	// village
 	float villageStart, villageEnd;
+
+	// environment
+	WorldWeather weather;
+	int time;
+
+	// the world's own entities
+	std::shared_ptr<WorldEntities> entities;
+
+	WorldData2(void)
+		: startX(0), indoor(false), indoorWidth(0), style(WorldBGType::Forest),
+		  villageStart(0), villageEnd(0), weather(WorldWeather::None), time(-1) {}
 };
 
 class WorldSystem : public entityx::System<WorldSystem>, public entityx::Receiver<WorldSystem> {
 private:
 	WorldData2 world;
 
+	/**
+	 * Guards the active world against being swapped out mid-render.
+	 */
+	std::mutex worldMutex;
+
+	/**
+	 * The worlds linked to the left and right of the active one. These are
+	 * built on a worker thread while the active world is played, so walking
+	 * into one only costs an entity manager swap.
+	 */
+	std::future<WorldData2> worldLeft, worldRight;
+
 	WorldWeather weather;
 
 	Mix_Music *bgmObj;
 
-	std::vector<std::string> bgFiles;
-
 	TextureIterator bgTex;
+	GLuint indoorTex;
 
-	XMLDocument xmlDoc;
-
-	std::string currentXMLFile;
+	// set when the active world changes, so its textures get loaded by render()
+	bool texturesOutdated;
+
+	/**
+	 * The ground, kept in a vertex buffer as chunks of columns. A chunk is
+	 * built when it first comes on screen after the world is loaded.
+	 */
+	GLuint dirtVBO;
+	std::vector<bool> dirtyChunks;
+
+	/**
+	 * Grass blades are chunked along with the ground, but their heights, and
+	 * whether they're pressed down, are read by the shader from a texture of
+	 * one texel per column. Only columns whose state changes are re-sent.
+	 */
+	GLuint grassVBO;
+	GLuint grassTex;
+	vec2 grassTexSize;
+	GLint grassBlade;
+	std::vector<unsigned int> grassChanged;
+
+	// the column each entity on the ground is pressing, and how many entities
+	// are pressing each column
+	std::unordered_map<entityx::Entity::Id, unsigned int> grassPressing;
+	std::unordered_map<unsigned int, unsigned int> grassWeight;
+
+	/**
+	 * Moves an entity's weight onto the given column, or off the grass when
+	 * the column is negative.
+	 */
+	void stepGrass(entityx::Entity::Id id, int column);
+
+	/**
+	 * Lets the grass up everywhere, forgetting who was standing on it.
+	 */
+	void releaseGrass(void);
+
+	/**
+	 * The parallax layers, built once per world as one repeating quad each;
+	 * the last quad is the indoor backdrop.
+	 */
+	GLuint layerVBO;
+	std::array<vec2, WORLD_LAYER_COUNT> layerDims;
+
+	// each quad's lower left corner and size, for culling
+	std::array<std::pair<vec2, vec2>, WORLD_LAYER_COUNT + 1> layerBounds;
+
+	void buildLayers(void);
+	void drawLayers(void);
+
+	void resetTerrain(void);
+	void buildChunks(unsigned int cStart, unsigned int cEnd);
+	void drawDirt(unsigned int first, unsigned int last);
+	void drawGrass(unsigned int first, unsigned int last);
+
+	static WorldWeather toWeather(const std::string &s);
+	static std::future<WorldData2> prebuild(const std::string& file);
+
+	void activate(WorldData2 w);
 
 public:
 	explicit WorldSystem(void);
@@ -159,7 +253,7 @@ public:
 	{ return weather; }
 
 	inline const std::string& getXMLFile(void) const
-	{ return currentXMLFile; }
+	{ return world.xmlFile; }
 
 	void setWeather(const std::string &s);
 
@@ -171,11 +265,31 @@ public:
 	// worlddata2 stuff
 	WorldData2 worldData;
 
-	void generate(unsigned int width = 0);
+	static void generate(WorldData2& world, unsigned int width = 0);
 	void addHole(const unsigned int& start, const unsigned int& end);
+
+	/**
+	 * Flattens, or lets back up, the grass on the given column.
+	 */
+	void pressGrass(unsigned int column, bool pressed);
 	void addHill(const ivec2& peak, const unsigned int& width);
 
+	/**
+	 * Writes the world's entities to a snapshot file next to its XML, named
+	 * after the XML file if none is given, or puts them back from one.
+	 */
 	bool save(const std::string& file);
+	bool restore(const std::string& file);
+
+	/**
+	 * Builds the world described by the given XML file, entities and all,
+	 * without touching the active world or GL; safe to call from any thread.
+	 */
+	static WorldData2 build(const std::string& file);
+
+	/**
+	 * Builds the given world and makes it the active one.
+	 */
 	void load(const std::string& file);
 };
 
@@ -26,6 +26,12 @@ using namespace tinyxml2;
 #include <ui.hpp>
 #include <gametime.hpp>
 #include <player.hpp>
+#include <activity.hpp>
+#include <pools.hpp>
+#include <lights.hpp>
+#include <rendercommands.hpp>
+#include <streambuffer.hpp>
+#include <gputimer.hpp>
 
 #include <fstream>
 #include <mutex>
@@ -61,6 +67,9 @@ static unsigned int fps=0;
 // handles all logic operations
 void logic(void);
 
+// moves the camera to where it should be for this frame
+void updateCamera(void);
+
 // handles all rendering operations
 void render(void);
 
@@ -109,7 +118,7 @@ int main(int argc, char *argv[])
 	SDL_GL_SetSwapInterval(1); // v-sync
 	SDL_ShowCursor(SDL_DISABLE); // hide the mouse
 	glViewport(0, 0, game::SCREEN_WIDTH, game::SCREEN_HEIGHT);
-	glEnable(GL_BLEND);
+	Render::state::enable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	glClearColor(1,1,1,1);
 
@@ -121,6 +130,11 @@ int main(int argc, char *argv[])
 
 	// create shaders
 	Render::initShaders();
+	Render::gpuTimer.init();
+
+	// pick what draws the render commands
+	if (game::config::RENDER_BACKEND == "null")
+		Render::setBackend(std::unique_ptr<Render::Backend>(new Render::NullBackend));
 
 	// load up some fresh hot brice
 	game::briceLoad();
@@ -225,6 +239,9 @@ int main(int argc, char *argv[])
 	}).detach();
 
 	while (game::engine.shouldRun()) {
+		// everything drawn this frame, lights and culling included, sees the
+		// same view
+		updateCamera();
 		game::engine.render(0);
 		render();
 	}
@@ -263,16 +280,18 @@ void mainLoop(void){
 	}
 }
 
-void render() {
+void updateCamera(void) {
 	const auto SCREEN_WIDTH = game::SCREEN_WIDTH;
 	const auto SCREEN_HEIGHT = game::SCREEN_HEIGHT;
 
 	//offset.x = game::entities.Iterator.begin().component<Position>().x;// + player->width / 2;
 
-	game::entities.each<Position>([](entityx::Entity entity, Position &position) {
-		(void)entity;
-		offset.x = position.x;
-	});
+	auto world = game::engine.getWorld();
+	if (!world->camera.empty()) {
+		auto target = world->camera.front();
+		if (target.valid() && target.has_component<Position>())
+			offset.x = target.component<Position>()->x;
+	}
 
 	auto worldWidth = game::engine.getSystem<WorldSystem>()->getWidth();
 	if (worldWidth < (int)SCREEN_WIDTH)
@@ -284,6 +303,11 @@ void render() {
 
 	// ortho y snapping
 	offset.y = /*std::max(player->loc.y + player->height / 2,*/ SCREEN_HEIGHT / 2.0f; /*);*/
+}
+
+void render() {
+	const auto SCREEN_WIDTH = game::SCREEN_WIDTH;
+	const auto SCREEN_HEIGHT = game::SCREEN_HEIGHT;
 
 	// "setup"
 	glm::mat4 projection = glm::ortho(floor(offset.x - SCREEN_WIDTH / 2),          // left
@@ -302,16 +326,23 @@ void render() {
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	// TODO add depth
-    glEnable(GL_DEPTH_TEST);
+    Render::state::enable(GL_DEPTH_TEST);
 
 	Render::textShader.use();
 		glUniformMatrix4fv(Render::textShader.uniform[WU_transform], 1, GL_FALSE, glm::value_ptr(ortho));
-    	glUniform4f(Render::textShader.uniform[WU_tex_color], 1.0, 1.0, 1.0, 1.0);
+    	Render::state::uniform4f(Render::textShader.uniform[WU_tex_color], 1.0, 1.0, 1.0, 1.0);
 	Render::textShader.unuse();
+	Render::fontShader.use();
+		glUniformMatrix4fv(Render::fontShader.uniform[FU_ortho], 1, GL_FALSE, glm::value_ptr(ortho));
+	Render::fontShader.unuse();
     Render::worldShader.use();
 		glUniformMatrix4fv(Render::worldShader.uniform[WU_ortho], 1, GL_FALSE, glm::value_ptr(ortho));
 		glUniformMatrix4fv(Render::worldShader.uniform[WU_transform], 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
 	Render::worldShader.unuse();
+	Render::grassShader.use();
+		glUniformMatrix4fv(Render::grassShader.uniform[WU_ortho], 1, GL_FALSE, glm::value_ptr(ortho));
+		glUniformMatrix4fv(Render::grassShader.uniform[WU_transform], 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
+	Render::grassShader.unuse();
 
 	// draw the world and player
 	game::engine.getSystem<WorldSystem>()->render();
@@ -328,12 +359,51 @@ void render() {
 	// draw the debug overlay if desired
 	if (ui::debug) {
 		auto pos = game::engine.getSystem<PlayerSystem>()->getPosition();
+		auto activity = game::engine.getSystem<ActivitySystem>();
+		const auto& commands = Render::getBackend().getStats();
+		auto gl = Render::state::getLastFrame();
+		auto stream = Render::stream.getLastFrame();
+		auto lights = game::engine.getSystem<LightSystem>();
+		auto sprites = Render::cull::getLastFrame(CK_sprites);
+		auto layers = Render::cull::getLastFrame(CK_layers);
+		auto text = Render::cull::getLastFrame(CK_text);
+		auto gpu = Render::gpuTimer.getSummary();
+
+		std::string pools;
+		for (const auto& p : game::pools::getStats()) {
+			if (p.live > 0) {
+				pools += "\n" + p.name + ": " + std::to_string(p.live) + '/' + std::to_string(p.capacity) +
+				         " (" + std::to_string(p.bytes / 1024) + " KiB)";
+			}
+		}
+
 		ui::putText(offset.x-SCREEN_WIDTH/2, (offset.y+SCREEN_HEIGHT/2)-ui::fontSize,
-		            "loc: (%+.2f, %+.2f)\nticks: %u\nxml: %s",
+		            "loc: (%+.2f, %+.2f)\nticks: %u\nxml: %s\nawake: %u + %u / %u\nsprites: %u commands in %u draws\ntext: %u commands in %u draws\ngl state: %u set, %u skipped\nstream: %u writes, %u KiB, %u orphaned\nlights: %u (%u dropped%s)\nculled: sprites %u/%u, layers %u/%u, text %u/%u\ngpu%s: %s%s",
 					pos.x,
 					pos.y,
 					game::time::getTickCount(),
-					game::engine.getSystem<WorldSystem>()->getXMLFile().c_str()
+					game::engine.getSystem<WorldSystem>()->getXMLFile().c_str(),
+					activity->getActiveCount(),
+					activity->getLowRateCount(),
+					activity->getTotalCount(),
+					commands.commands[RP_world],
+					commands.draws[RP_world],
+					commands.commands[RP_text],
+					commands.draws[RP_text],
+					gl.issued,
+					gl.skipped,
+					stream.writes,
+					static_cast<unsigned int>(stream.bytes / 1024),
+					stream.orphans,
+					lights->getLightCount(),
+					lights->getDroppedCount(),
+					lights->isBuffered() ? ", buffered" : "",
+					sprites.culled, sprites.culled + sprites.drawn,
+					layers.culled, layers.culled + layers.drawn,
+					text.culled, text.culled + text.drawn,
+					(Render::gpuTimer.getMode() == GPUTimer::Finish) ? " (finished)" : "",
+					(Render::gpuTimer.getMode() == GPUTimer::Off) ? "not timed" : gpu.c_str(),
+					pools.c_str()
 		            );
 		/*ui::putText(offset.x-SCREEN_WIDTH/2, (offset.y+SCREEN_HEIGHT/2)-ui::fontSize,
 					"fps: %d\ngrounded:%d\nresolution: %ux%u\nentity cnt: %d\nloc: (%+.2f, %+.2f)\nticks: %u\nvolume: %f\nweather: %s\nxml: %s",
@@ -373,7 +443,7 @@ void render() {
 			}
 
 			Render::textShader.use();
-				glBindTexture(GL_TEXTURE_2D, tracerText);
+				Render::state::bindTexture(tracerText);
 				Render::textShader.enable();
 				glVertexAttribPointer(Render::worldShader.coord, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), &tpoint[0]);
 				glVertexAttribPointer(Render::worldShader.tex, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), &tpoint[3]);
@@ -390,13 +460,21 @@ void render() {
 	if (currentMenu)
 		ui::menu::draw();
 
+	// draw all the text put this frame
+	ui::flushText();
+
 	// draw the mouse
 	Render::textShader.use();
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, mouseTex);
+		Render::state::activeTexture(GL_TEXTURE0);
+		Render::state::bindTexture(mouseTex);
 		Render::useShader(&Render::textShader);
 		Render::drawRect(ui::mouse, ui::mouse + 15, -9.9);
 	Render::textShader.unuse();
+
+	Render::state::endFrame();
+	Render::stream.endFrame();
+	Render::cull::endFrame();
+	Render::gpuTimer.endFrame();
 }
 
 void logic(){
@@ -0,0 +1,14 @@
+attribute vec3 coord2d;
+attribute vec2 tex_coord;
+attribute vec4 color;
+
+uniform mat4 ortho;
+
+varying vec2 texCoord;
+varying vec4 fontColor;
+
+void main(){
+    texCoord = tex_coord;
+    fontColor = color;
+    gl_Position = ortho * vec4(coord2d.xyz, 1.0);
+}
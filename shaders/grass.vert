@@ -0,0 +1,39 @@
+attribute vec3 coord2d;
+attribute vec2 tex_coord;
+attribute vec2 blade;
+
+uniform vec4 tex_color;
+uniform mat4 ortho;
+uniform mat4 transform;
+
+uniform sampler2D grass;
+uniform vec2 grass_size;
+uniform float wind_time;
+
+varying vec2 texCoord;
+varying vec4 color;
+varying vec4 fragCoord;
+
+void main(){
+	vec4 pos = vec4(coord2d.xyz, 1.0);
+
+	// blade.x is the column, blade.y which blade's top this is (0 for the bottom)
+	if (blade.y > 0.0) {
+		vec2 at = vec2((mod(blade.x, grass_size.x) + 0.5) / grass_size.x,
+		               (floor(blade.x / grass_size.x) + 0.5) / grass_size.y);
+		vec4 state = texture2DLod(grass, at, 0.0);
+
+		// heights are stored in sixteenths; pressed grass is flattened
+		float height = (blade.y < 1.5 ? state.r : state.g) * 255.0 / 16.0;
+		if (state.b > 0.5)
+			height /= 4.0;
+
+		pos.y += height;
+		pos.x += sin(wind_time + blade.x * 0.4) * height * 0.2;
+	}
+
+	color = tex_color;
+	texCoord = tex_coord;
+	fragCoord = pos;
+	gl_Position = ortho * transform * pos;
+}
@@ -0,0 +1,10 @@
+varying vec2 lightCoord;
+varying vec4 lightColor;
+
+void main()
+{
+	// the same falloff world.frag gives each light
+	float attenuation = clamp(1.0 - dot(lightCoord, lightCoord), 0.0, 1.0);
+	attenuation *= attenuation;
+	gl_FragColor = vec4(lightColor.rgb * attenuation, 1.0);
+}
@@ -0,0 +1,15 @@
+attribute vec2 coord2d;
+attribute vec2 tex_coord;
+attribute vec4 color;
+
+// the part of the world the buffer covers: left, bottom, width, height
+uniform vec4 view;
+
+varying vec2 lightCoord;
+varying vec4 lightColor;
+
+void main(){
+	lightCoord = tex_coord * 2.0 - 1.0;
+	lightColor = color;
+	gl_Position = vec4((coord2d - view.xy) / view.zw * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,38 @@
+uniform sampler2D sampler;
+uniform vec4 outline_color;
+uniform float outline_width;
+uniform vec4 shadow_color;
+uniform vec2 shadow_offset;
+
+varying vec2 texCoord;
+varying vec4 fontColor;
+
+void main(){
+	// the alpha is a distance field, with the outline at 0.5
+	float dist = texture2D(sampler, texCoord).a;
+	float aa = max(fwidth(dist) * 0.5, 0.001);
+
+	float fill = smoothstep(0.5 - aa, 0.5 + aa, dist);
+	float line = smoothstep(0.5 - outline_width - aa, 0.5 - outline_width + aa, dist);
+
+	// layers are stacked front to back: the glyph, its outline (the glyph grown
+	// by outline_width), then its shadow (the glyph again, moved)
+	float shadowDist = texture2D(sampler, texCoord - shadow_offset).a;
+	float shadow = smoothstep(0.5 - aa, 0.5 + aa, shadowDist) * shadow_color.a;
+	float outline = line * outline_color.a;
+
+	vec3 rgb = fontColor.rgb * fill;
+	float alpha = fill;
+
+	rgb += outline_color.rgb * outline * (1.0 - alpha);
+	alpha += outline * (1.0 - alpha);
+
+	rgb += shadow_color.rgb * shadow * (1.0 - alpha);
+	alpha += shadow * (1.0 - alpha);
+
+	alpha *= fontColor.a;
+	if (alpha < 0.01)
+		discard;
+
+	gl_FragColor = vec4(rgb / max(alpha / fontColor.a, 0.001), alpha);
+}
@@ -11,6 +11,15 @@ uniform vec4 lightColor[128];
 uniform float lightImpact;
 uniform int lightSize;
 
+// per screen column: a count in the bottom row, indices into light[] above it
+uniform sampler2D lightTiles;
+uniform vec4 lightTileInfo; // left edge, column width, columns, rows
+
+// all the lights drawn ahead of time, and the part of the world it covers;
+// no width means there's no buffer
+uniform sampler2D lightBuffer;
+uniform vec4 lightBufferView; // left, bottom, width, height
+
 void main()
 {
 	vec2 texLoc = vec2(texCoord.x, 1-texCoord.y);
@@ -19,8 +28,16 @@ void main()
 		discard;
   
 	vec4 shadeColor = vec4(0.0f, 0.0f, 0.0f, 0.0f);
-	if (lightImpact > 0.0f) {
-		for (int i = 0; i < lightSize; i++) {
+	if (lightImpact > 0.0f && lightBufferView.z > 0.0f) {
+		vec2 at = (fragCoord.xy - lightBufferView.xy) / lightBufferView.zw;
+		shadeColor += vec4(texture2D(lightBuffer, at).rgb, 0.0f) * lightImpact;
+	} else if (lightImpact > 0.0f) {
+		float tile = clamp(floor((fragCoord.x - lightTileInfo.x) / lightTileInfo.y), 0.0f, lightTileInfo.z - 1.0f);
+		float s = (tile + 0.5f) / lightTileInfo.z;
+		int count = int(texture2D(lightTiles, vec2(s, 0.5f / lightTileInfo.w)).r * 255.0f + 0.5f);
+
+		for (int j = 0; j < count && j < lightSize; j++) {
+			int i = int(texture2D(lightTiles, vec2(s, (float(j) + 1.5f) / lightTileInfo.w)).r * 255.0f + 0.5f);
 			vec2 loc = light[i].xy;
 			float dist = length(loc - fragCoord.xy);
 			if (dist < light[i].w) {
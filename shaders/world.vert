@@ -4,6 +4,7 @@ attribute vec2 tex_coord;
 uniform vec4 tex_color;
 uniform mat4 ortho;
 uniform mat4 transform;
+uniform vec2 tex_offset;
 
 varying vec2 texCoord;
 varying vec4 color;
@@ -11,7 +12,7 @@ varying vec4 fragCoord;
 
 void main(){
 	color = tex_color;
-    texCoord = tex_coord;
+    texCoord = tex_coord + tex_offset;
     fragCoord = vec4(coord2d.xyz, 1.0);
 	gl_Position = ortho * transform * fragCoord;
 }
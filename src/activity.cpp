@@ -0,0 +1,154 @@
+#include <activity.hpp>
+
+#include <common.hpp>
+#include <config.hpp>
+#include <dirty.hpp>
+#include <engine.hpp>
+#include <player.hpp>
+
+void ActivitySystem::configure(entityx::EventManager &ev)
+{
+	ev.subscribe<WorldActivateEvent>(*this);
+}
+
+void ActivitySystem::receive(const WorldActivateEvent &wae)
+{
+	std::lock_guard<std::mutex> lock (mtx);
+
+	if (worldEvents != nullptr) {
+		worldEvents->unsubscribe<entityx::ComponentAddedEvent<Position>>(*this);
+		worldEvents->unsubscribe<entityx::ComponentRemovedEvent<Position>>(*this);
+		worldEvents->unsubscribe<entityx::EntityDestroyedEvent>(*this);
+	}
+
+	cells.clear();
+	cellOf.clear();
+	active.clear();
+	lowRate.clear();
+
+	// bin everything the new world already has
+	wae.world->entities.each<Position>([this](entityx::Entity e, Position &p) {
+		insert(e, cellFor(p.x));
+	});
+
+	worldEvents = &wae.world->events;
+	worldEvents->subscribe<entityx::ComponentAddedEvent<Position>>(*this);
+	worldEvents->subscribe<entityx::ComponentRemovedEvent<Position>>(*this);
+	worldEvents->subscribe<entityx::EntityDestroyedEvent>(*this);
+	changed = true;
+	sweep = true;
+}
+
+void ActivitySystem::receive(const entityx::ComponentAddedEvent<Position> &cae)
+{
+	std::lock_guard<std::mutex> lock (mtx);
+
+	auto e = cae.entity;
+	erase(e.id());
+	insert(e, cellFor(e.component<Position>()->x));
+}
+
+void ActivitySystem::receive(const entityx::ComponentRemovedEvent<Position> &cre)
+{
+	std::lock_guard<std::mutex> lock (mtx);
+	erase(cre.entity.id());
+}
+
+void ActivitySystem::receive(const entityx::EntityDestroyedEvent &ede)
+{
+	std::lock_guard<std::mutex> lock (mtx);
+	erase(ede.entity.id());
+}
+
+void ActivitySystem::insert(entityx::Entity e, int cell)
+{
+	cells[cell].push_back(e);
+	cellOf[e.id()] = cell;
+	changed = true;
+}
+
+void ActivitySystem::erase(entityx::Entity::Id id)
+{
+	auto it = cellOf.find(id);
+	if (it == cellOf.end())
+		return;
+
+	auto& cell = cells[it->second];
+	auto pos = std::find_if(cell.begin(), cell.end(),
+		[&id](const entityx::Entity& e) { return e.id() == id; });
+
+	if (pos != cell.end()) {
+		*pos = cell.back();
+		cell.pop_back();
+	}
+
+	if (cell.empty())
+		cells.erase(it->second);
+
+	cellOf.erase(it);
+	changed = true;
+}
+
+void ActivitySystem::rebin(entityx::Entity e, float x)
+{
+	auto cell = cellFor(x);
+	auto it = cellOf.find(e.id());
+
+	if (it == cellOf.end() || it->second != cell) {
+		erase(e.id());
+		insert(e, cell);
+	}
+}
+
+void ActivitySystem::rebuild(void)
+{
+	active.clear();
+	lowRate.clear();
+
+	for (int c = lowStart; c <= lowEnd; c++) {
+		auto cell = cells.find(c);
+		if (cell == cells.end())
+			continue;
+
+		auto& list = (c >= activeStart && c <= activeEnd) ? active : lowRate;
+		list.insert(list.end(), cell->second.begin(), cell->second.end());
+	}
+
+	changed = false;
+}
+
+void ActivitySystem::update(entityx::EntityManager &en, entityx::EventManager &ev, entityx::TimeDelta dt)
+{
+	(void)ev;
+	(void)dt;
+
+	std::lock_guard<std::mutex> lock (mtx);
+
+	frame++;
+
+	// anything that moved, awake or not, may have wandered into another cell;
+	// writes made later in the frame we last looked at are picked up now, and
+	// if we've fallen too far behind everything gets looked at
+	auto now = game::time::getFrameCount();
+	auto moved = [this](entityx::Entity e, Position &p) { rebin(e, p.x); };
+
+	if (sweep || seen == 0 || !Dirty<Position>::each(seen - 1, moved))
+		en.each<Position>(moved);
+
+	seen = now;
+	sweep = false;
+
+	// wake up whatever is around the camera and the player
+	auto player = game::engine.getSystem<PlayerSystem>()->getPosition();
+	float left  = std::min(offset.x, player.x) - game::SCREEN_WIDTH / 2 - ACTIVITY_MARGIN;
+	float right = std::max(offset.x, player.x) + game::SCREEN_WIDTH / 2 + ACTIVITY_MARGIN;
+
+	int as = cellFor(left), ae = cellFor(right);
+	int ls = cellFor(left - ACTIVITY_LOW_RATE_MARGIN), le = cellFor(right + ACTIVITY_LOW_RATE_MARGIN);
+
+	if (changed || as != activeStart || ae != activeEnd || ls != lowStart || le != lowEnd) {
+		activeStart = as, activeEnd = ae;
+		lowStart = ls, lowEnd = le;
+		rebuild();
+	}
+}
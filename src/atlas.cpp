@@ -0,0 +1,229 @@
+#include <atlas.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <texture.hpp>
+
+namespace game {
+	TextureAtlas atlas;
+}
+
+int TextureAtlas::fit(const Page& p, size_t i, int w, int h)
+{
+	int x = p.skyline[i].x;
+	if (x + w > ATLAS_PAGE_SIZE)
+		return -1;
+
+	// the image sits on the highest stretch of skyline it spans
+	int y = 0;
+	for (int left = w; left > 0; i++) {
+		y = std::max(y, p.skyline[i].y);
+		left -= p.skyline[i].w;
+	}
+
+	return (y + h <= ATLAS_PAGE_SIZE) ? y : -1;
+}
+
+void TextureAtlas::raise(Page& p, const Rect& r)
+{
+	int x0 = r.x;
+	int x1 = std::min(r.x + r.w + ATLAS_PADDING, ATLAS_PAGE_SIZE);
+	int top = std::min(r.y + r.h + ATLAS_PADDING, ATLAS_PAGE_SIZE);
+
+	std::vector<Node> out;
+	auto add = [&out](int x, int y, int w) {
+		if (w <= 0)
+			return;
+
+		if (!out.empty() && out.back().y == y)
+			out.back().w += w;
+		else
+			out.push_back(Node {x, y, w});
+	};
+
+	for (const auto& n : p.skyline) {
+		int nx1 = n.x + n.w;
+
+		add(n.x, n.y, std::min(nx1, x0) - n.x);
+
+		int ox0 = std::max(n.x, x0), ox1 = std::min(nx1, x1);
+		add(ox0, std::max(n.y, top), ox1 - ox0);
+
+		int ax0 = std::max(n.x, x1);
+		add(ax0, n.y, nx1 - ax0);
+	}
+
+	p.skyline = std::move(out);
+}
+
+TextureAtlas::Page& TextureAtlas::getPage(unsigned int i)
+{
+	while (pages.size() <= i)
+		pages.push_back(Page {0, { Node {0, 0, ATLAS_PAGE_SIZE} }});
+
+	return pages[i];
+}
+
+TextureAtlas::Rect TextureAtlas::pack(int w, int h)
+{
+	int pw = w + ATLAS_PADDING, ph = h + ATLAS_PADDING;
+
+	// bottom-left: the lowest spot on any page, then the leftmost
+	for (unsigned int pi = 0; pi < pages.size(); pi++) {
+		auto& p = pages[pi];
+		int bestY = -1, bestX = 0;
+
+		for (size_t i = 0; i < p.skyline.size(); i++) {
+			int y = fit(p, i, pw, ph);
+			if (y >= 0 && (bestY < 0 || y < bestY)) {
+				bestY = y;
+				bestX = p.skyline[i].x;
+			}
+		}
+
+		if (bestY >= 0)
+			return Rect {pi, bestX, bestY, w, h, false};
+	}
+
+	// nothing fits, start a new page
+	unsigned int pi = pages.size();
+	getPage(pi);
+	return Rect {pi, 0, 0, w, h, false};
+}
+
+AtlasRegion TextureAtlas::get(const std::string& path)
+{
+	if (!cacheLoaded)
+		loadCache();
+
+	auto found = placed.find(path);
+	if (found != placed.end() && found->second.uploaded) {
+		const auto& r = found->second;
+		return AtlasRegion {
+			pages[r.page].tex,
+			vec2(static_cast<float>(r.x) / ATLAS_PAGE_SIZE, static_cast<float>(r.y) / ATLAS_PAGE_SIZE),
+			vec2(static_cast<float>(r.x + r.w) / ATLAS_PAGE_SIZE, static_cast<float>(r.y + r.h) / ATLAS_PAGE_SIZE),
+			vec2(r.w, r.h)
+		};
+	}
+
+	SDL_Surface *image = IMG_Load(path.c_str());
+	if (image == nullptr)
+		return AtlasRegion {0, vec2(0, 0), vec2(1, 1), vec2(0, 0)};
+
+	// big images aren't worth the page space
+	if (image->w > ATLAS_MAX_IMAGE || image->h > ATLAS_MAX_IMAGE) {
+		SDL_FreeSurface(image);
+		return AtlasRegion {Texture::loadTexture(path), vec2(0, 0), vec2(1, 1), Texture::imageDim(path)};
+	}
+
+	// place it where the cache says, unless the image has changed size since
+	if (found == placed.end() || found->second.w != image->w || found->second.h != image->h) {
+		auto r = pack(image->w, image->h);
+		raise(getPage(r.page), r);
+		placed[path] = r;
+		cacheChanged = true;
+	}
+
+	auto& r = placed[path];
+	auto& page = getPage(r.page);
+
+	if (page.tex == 0) {
+		glGenTextures(1, &page.tex);
+		Render::state::bindTexture(page.tex);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, 0,
+		             GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	}
+
+	// whatever the file's format, the page wants RGBA bytes
+	SDL_Surface *rgba = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_ABGR8888, 0);
+	SDL_FreeSurface(image);
+	if (rgba == nullptr)
+		return AtlasRegion {0, vec2(0, 0), vec2(1, 1), vec2(0, 0)};
+
+	Render::state::bindTexture(page.tex);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, rgba->pitch / 4);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, r.x, r.y, r.w, r.h, GL_RGBA, GL_UNSIGNED_BYTE, rgba->pixels);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	SDL_FreeSurface(rgba);
+
+	r.uploaded = true;
+	return get(path);
+}
+
+void TextureAtlas::loadCache(void)
+{
+	cacheLoaded = true;
+
+	std::ifstream in (ATLAS_CACHE_FILE);
+	std::string line;
+
+	// a cache made for another page size is no good
+	int size = 0;
+	if (!std::getline(in, line) || std::sscanf(line.c_str(), "atlas %d", &size) != 1 || size != ATLAS_PAGE_SIZE)
+		return;
+
+	// what's been read so far, by page, padding and all; images sharing space
+	// would draw over each other
+	std::vector<std::vector<Rect>> taken (ATLAS_CACHE_PAGES_MAX);
+	auto overlaps = [&taken](const Rect& r) {
+		for (const auto& o : taken[r.page]) {
+			if (r.x < o.x + o.w + ATLAS_PADDING && o.x < r.x + r.w + ATLAS_PADDING &&
+			    r.y < o.y + o.h + ATLAS_PADDING && o.y < r.y + r.h + ATLAS_PADDING)
+				return true;
+		}
+
+		return false;
+	};
+
+	while (std::getline(in, line)) {
+		std::istringstream is (line);
+		Rect r {0, 0, 0, 0, 0, false};
+		std::string path;
+
+		is >> r.page >> r.x >> r.y >> r.w >> r.h;
+		std::getline(is >> std::ws, path);
+
+		// one bad line means the file can't be trusted; start over and let
+		// the layout be rebuilt as images come in
+		if (!is || path.empty() || r.page >= ATLAS_CACHE_PAGES_MAX ||
+		    r.w <= 0 || r.h <= 0 || r.w > ATLAS_PAGE_SIZE || r.h > ATLAS_PAGE_SIZE ||
+		    r.x < 0 || r.y < 0 || r.x > ATLAS_PAGE_SIZE - r.w || r.y > ATLAS_PAGE_SIZE - r.h ||
+		    placed.count(path) != 0 || overlaps(r)) {
+			pages.clear();
+			placed.clear();
+			cacheChanged = true;
+			return;
+		}
+
+		raise(getPage(r.page), r);
+		placed[path] = r;
+		taken[r.page].push_back(r);
+	}
+}
+
+void TextureAtlas::saveCache(void)
+{
+	if (!cacheChanged)
+		return;
+
+	std::ofstream out (ATLAS_CACHE_FILE);
+	out << "atlas " << ATLAS_PAGE_SIZE << '\n';
+
+	for (const auto& p : placed) {
+		const auto& r = p.second;
+		out << r.page << ' ' << r.x << ' ' << r.y << ' ' << r.w << ' ' << r.h << ' ' << p.first << '\n';
+	}
+
+	cacheChanged = false;
+}
@@ -0,0 +1,73 @@
+#include <commands.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+#include <engine.hpp>
+
+// every thread's command buffer, for playback
+static std::mutex buffersMutex;
+static std::vector<CommandBuffer *> buffers;
+
+std::vector<CommandBuffer::Recorded> CommandBuffer::orphans;
+
+CommandBuffer::CommandBuffer(void)
+{
+	std::lock_guard<std::mutex> lock (buffersMutex);
+	buffers.push_back(this);
+}
+
+CommandBuffer::~CommandBuffer(void)
+{
+	std::lock_guard<std::mutex> lock (buffersMutex);
+	buffers.erase(std::remove(buffers.begin(), buffers.end(), this), buffers.end());
+
+	std::lock_guard<std::mutex> lock2 (mtx);
+	std::move(commands.begin(), commands.end(), std::back_inserter(orphans));
+}
+
+void CommandBuffer::push(Command c)
+{
+	// stamp the command with the world it was meant for
+	auto world = game::engine.getWorld();
+
+	std::lock_guard<std::mutex> lock (mtx);
+	commands.push_back(Recorded {world, std::move(c)});
+}
+
+void CommandBuffer::playAll(entityx::EntityManager &en)
+{
+	std::vector<Recorded> toRun;
+
+	// take everything queued so far, then run it with no locks held: commands
+	// are free to record more, or to touch a thread's buffer for the first time
+	{
+		std::lock_guard<std::mutex> lock (buffersMutex);
+		std::swap(toRun, orphans);
+
+		for (auto b : buffers) {
+			std::lock_guard<std::mutex> lock2 (b->mtx);
+			std::move(b->commands.begin(), b->commands.end(), std::back_inserter(toRun));
+			b->commands.clear();
+		}
+	}
+
+	for (auto& r : toRun) {
+		auto world = r.world.lock();
+		if (world && &world->entities == &en)
+			r.command(en);
+	}
+}
+
+namespace game {
+	CommandBuffer& commands(void)
+	{
+		thread_local CommandBuffer buffer;
+		return buffer;
+	}
+
+	void playCommands(entityx::EntityManager &en)
+	{
+		CommandBuffer::playAll(en);
+	}
+}
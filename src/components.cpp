@@ -4,22 +4,41 @@
 #include <events.hpp>
 
 #include <render.hpp>
+#include <rendercommands.hpp>
 #include <engine.hpp>
+#include <dirty.hpp>
+#include <activity.hpp>
 
 void MovementSystem::update(entityx::EntityManager &en, entityx::EventManager &ev, entityx::TimeDelta dt)
 {
+	(void)en;
 	(void)ev;
-	en.each<Position, Direction>([dt](entityx::Entity entity, Position &position, Direction &direction) {
-		(void)entity;
+	game::engine.getSystem<ActivitySystem>()->each<Position, Direction>(dt,
+		[](entityx::Entity entity, entityx::TimeDelta dt, Position &position, Direction &direction) {
+		if (direction.x == 0 && direction.y == 0)
+			return;
+
+		Dirty<Position>::touch(entity);
 		position.x += direction.x * dt;
 		position.y += direction.y * dt;
 	});
 }
 
+void PhysicsSystem::configure(entityx::EventManager &ev)
+{
+	ev.subscribe<WorldActivateEvent>(*this);
+}
+
+void PhysicsSystem::receive(const WorldActivateEvent &wae)
+{
+	bodies.bind(wae.world->entities, wae.world->events);
+}
+
 void PhysicsSystem::update(entityx::EntityManager &en, entityx::EventManager &ev, entityx::TimeDelta dt)
 {
+	(void)en;
 	(void)ev;
-	en.each<Direction, Physics>([dt](entityx::Entity entity, Direction &direction, Physics &physics) {
+	bodies.each([dt](entityx::Entity entity, Direction &direction, Physics &physics) {
 		(void)entity;
 		// TODO GET GRAVITY FROM WOLRD
 		direction.y += physics.g * dt;
@@ -28,66 +47,43 @@ void PhysicsSystem::update(entityx::EntityManager &en, entityx::EventManager &ev
 
 void RenderSystem::update(entityx::EntityManager &en, entityx::EventManager &ev, entityx::TimeDelta dt)
 {
+	(void)en;
 	(void)ev;
-	Render::worldShader.use();
+	(void)dt;
+	auto& commands = Render::commands();
 
-	en.each<Visible, Sprite, Position>([dt](entityx::Entity entity, Visible &visible, Sprite &sprite, Position &pos) {
-		(void)entity;
-		// Verticies and shit
-		GLfloat tex_coord[] = {0.0, 0.0,
-							   1.0, 0.0,
-							   1.0, 1.0,
-
-							   1.0, 1.0,
-							   0.0, 1.0,
-							   0.0, 0.0};
-
-		GLfloat tex_coordL[] = {1.0, 0.0,
-								0.0, 0.0,
-								0.0, 1.0,
-
-								0.0, 1.0,
-								1.0, 1.0,
-								1.0, 0.0};
+	// a little wider than the view, which gets snapped to whole pixels
+	auto view = Render::getView(SPRITE_CULL_SLACK);
 
-		for (auto &S : sprite.sprite) {
-			float width = S.first.size.x;
-			float height = S.first.size.y;
+	// only entities near enough to the view to reach into it are looked at
+	game::engine.getSystem<ActivitySystem>()->eachIn<Visible, Sprite, Position>(
+		view.left - SPRITE_REACH, view.right + SPRITE_REACH,
+		[&commands, &view](entityx::Entity entity, Visible &visible, Sprite &sprite, Position &pos) {
+		(void)entity;
 
+		for (const auto &S : sprite.getSprite()) {
+			const auto& img = S.first.info();
 			vec2 loc = vec2(pos.x + S.first.offset.x, pos.y + S.first.offset.y);
 
-			GLfloat coords[] = {loc.x, 			loc.y, 			visible.z,
-								loc.x + width, 	loc.y, 			visible.z,
-								loc.x + width, 	loc.y + height, visible.z,
-
-								loc.x + width, 	loc.y + height, visible.z,
-								loc.x, 			loc.y + height, visible.z,
-								loc.x, 			loc.y, 			visible.z};
-
+			if (!Render::cull::test(CK_sprites, view, loc, img.size))
+				continue;
 
 			// make the entity hit flash red
 			// TODO
 			/*if (maxHitDuration-hitDuration) {
 				float flashAmt = 1-(hitDuration/maxHitDuration);
-				glUniform4f(Render::worldShader.uniform[WU_tex_color], 1.0, flashAmt, flashAmt, 1.0);
+				Render::state::uniform4f(Render::worldShader.uniform[WU_tex_color], 1.0, flashAmt, flashAmt, 1.0);
 			}*/
-			glBindTexture(GL_TEXTURE_2D, S.first.pic);
-			glUniform1i(Render::worldShader.uniform[WU_texture], 0);
-			Render::worldShader.enable();
-
-			glVertexAttribPointer(Render::worldShader.coord, 3, GL_FLOAT, GL_FALSE, 0, coords);
-			if (sprite.faceLeft)
-				glVertexAttribPointer(Render::worldShader.tex, 2, GL_FLOAT, GL_FALSE, 0 ,tex_coordL);
-			else
-				glVertexAttribPointer(Render::worldShader.tex, 2, GL_FLOAT, GL_FALSE, 0 ,tex_coord);
-			glDrawArrays(GL_TRIANGLES, 0, 6);
-
-			glUniform4f(Render::worldShader.uniform[WU_tex_color], 1.0, 1.0, 1.0, 1.0);
+			commands.drawSprite(RP_world, Render::worldShader, img.tex, img.uv0, img.uv1, loc, img.size,
+			                    visible.z, sprite.faceLeft);
 		}
 	});
 
-	Render::worldShader.disable();
-	Render::worldShader.unuse();
+	static const GLfloat white[4] = {1.0, 1.0, 1.0, 1.0};
+	commands.setUniform(RP_world, Render::worldShader, WU_tex_color, white, 4);
+
+	// remember where newly drawn images were packed, for next time
+	game::atlas.saveCache();
 }
 
 /*
@@ -118,7 +114,7 @@ void Entity::draw(void)
 						loc.x, loc.y, z};
 
 
-	glActiveTexture(GL_TEXTURE0);
+	Render::state::activeTexture(GL_TEXTURE0);
 
 	if (!alive)
 		return;
@@ -144,17 +140,17 @@ void Entity::draw(void)
 		if (speed && !(game::time::getTickCount() % ((2.0f/speed) < 1 ? 1 : (int)((float)2.0f/(float)speed)))) {
 			if (++texState == 9)
 				texState = 1;
-			glActiveTexture(GL_TEXTURE0);
+			Render::state::activeTexture(GL_TEXTURE0);
 			tex(texState);
 		}
 		if (!ground) {
-			glActiveTexture(GL_TEXTURE0);
+			Render::state::activeTexture(GL_TEXTURE0);
 			tex(0);
 		} else if (vel.x) {
-			glActiveTexture(GL_TEXTURE0);
+			Render::state::activeTexture(GL_TEXTURE0);
 			tex(texState);
 		} else {
-			glActiveTexture(GL_TEXTURE0);
+			Render::state::activeTexture(GL_TEXTURE0);
 			tex(0);
 		}
 		break;
@@ -164,7 +160,7 @@ void Entity::draw(void)
 		break;
 	case STRUCTURET:
 	default:
-		glActiveTexture(GL_TEXTURE0);
+		Render::state::activeTexture(GL_TEXTURE0);
 		tex(0);
 		break;
 	}
@@ -173,10 +169,10 @@ void Entity::draw(void)
 	// make the entity hit flash red
 	if (maxHitDuration-hitDuration) {
 		float flashAmt = 1-(hitDuration/maxHitDuration);
-		glUniform4f(Render::worldShader.uniform[WU_tex_color], 1.0, flashAmt, flashAmt, 1.0);
+		Render::state::uniform4f(Render::worldShader.uniform[WU_tex_color], 1.0, flashAmt, flashAmt, 1.0);
 	}
 
-	glUniform1i(Render::worldShader.uniform[WU_texture], 0);
+	Render::state::uniform1i(Render::worldShader.uniform[WU_texture], 0);
 	Render::worldShader.enable();
 
 	glVertexAttribPointer(Render::worldShader.coord, 3, GL_FLOAT, GL_FALSE, 0, coords);
@@ -186,7 +182,7 @@ void Entity::draw(void)
 		glVertexAttribPointer(Render::worldShader.tex, 2, GL_FLOAT, GL_FALSE, 0 ,tex_coord);
 	glDrawArrays(GL_TRIANGLES, 0, 6);
 
-	glUniform4f(Render::worldShader.uniform[WU_tex_color], 1.0, 1.0, 1.0, 1.0);
+	Render::state::uniform4f(Render::worldShader.uniform[WU_tex_color], 1.0, 1.0, 1.0, 1.0);
 NOPE:
 if (near && type != MOBT)
 	ui::putStringCentered(loc.x+width/2,loc.y-ui::fontSize-game::HLINE/2,name);
@@ -194,7 +190,7 @@ if (health != maxHealth) {
 
 	static GLuint frontH = Texture::genColor(Color(255,0,0));
 	static GLuint backH =  Texture::genColor(Color(150,0,0));
-	glUniform1i(Render::worldShader.uniform[WU_texture], 0);
+	Render::state::uniform1i(Render::worldShader.uniform[WU_texture], 0);
 
 	GLfloat coord_back[] = {
 		loc.x, 			loc.y + height, 			      z + 0.1f,
@@ -216,7 +212,7 @@ if (health != maxHealth) {
 		loc.x,                              loc.y + height,                   z,
 	};
 
-	glBindTexture(GL_TEXTURE_2D, backH);
+	Render::state::bindTexture(backH);
 	GLfloat tex[] = { 0.0, 0.0,
 					  1.0, 0.0,
 					  1.0, 1.0,
@@ -229,7 +225,7 @@ if (health != maxHealth) {
 	glVertexAttribPointer(Render::worldShader.tex, 2, GL_FLOAT, GL_FALSE, 0, tex);
 	glDrawArrays(GL_TRIANGLES, 0, 6);
 
-	glBindTexture(GL_TEXTURE_2D, frontH);
+	Render::state::bindTexture(frontH);
 	glVertexAttribPointer(Render::worldShader.coord, 3, GL_FLOAT, GL_FALSE, 0, coord_front);
 	glVertexAttribPointer(Render::worldShader.tex, 2, GL_FLOAT, GL_FALSE, 0, tex);
 	glDrawArrays(GL_TRIANGLES, 0, 6);
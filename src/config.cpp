@@ -23,6 +23,15 @@ namespace game {
 
 		std::string xmlFolder;
 
+		float        POOL_COMPACT_RATIO;
+		unsigned int POOL_COMPACT_MIN;
+
+		bool LIGHT_BUFFER;
+
+		std::string RENDER_BACKEND;
+
+		bool GPU_TIMING_FINISH;
+
 		void read(void) {
 			xml.LoadFile("config/settings.xml");
 			auto exml = xml.FirstChildElement("screen");
@@ -49,6 +58,25 @@ namespace game {
 			if (xmlFolder.empty())
 				xmlFolder = "xml/";
 
+			exml = xml.FirstChildElement("pools");
+			if (exml == nullptr || exml->QueryFloatAttribute("compact", &POOL_COMPACT_RATIO) != XML_NO_ERROR)
+				POOL_COMPACT_RATIO = 0.5f;
+			if (exml == nullptr || exml->QueryUnsignedAttribute("min", &POOL_COMPACT_MIN) != XML_NO_ERROR)
+				POOL_COMPACT_MIN = 256;
+
+			exml = xml.FirstChildElement("lighting");
+			if (exml == nullptr || exml->QueryBoolAttribute("buffer", &LIGHT_BUFFER) != XML_NO_ERROR)
+				LIGHT_BUFFER = false;
+
+			exml = xml.FirstChildElement("render");
+			RENDER_BACKEND = (exml != nullptr) ? exml->StrAttribute("backend") : "";
+			if (RENDER_BACKEND.empty())
+				RENDER_BACKEND = "gl";
+
+			exml = xml.FirstChildElement("profiler");
+			if (exml == nullptr || exml->QueryBoolAttribute("finish", &GPU_TIMING_FINISH) != XML_NO_ERROR)
+				GPU_TIMING_FINISH = false;
+
 			ui::initFonts();
 			ui::setFontFace(xml.FirstChildElement("font")->Attribute("path"));
 
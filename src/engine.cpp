@@ -7,54 +7,106 @@
 #include <window.hpp>
 #include <components.hpp>
 #include <player.hpp>
+#include <gametime.hpp>
+#include <activity.hpp>
+#include <dirty.hpp>
+#include <commands.hpp>
+#include <snapshot.hpp>
+#include <pools.hpp>
+#include <profiler.hpp>
+#include <lights.hpp>
+#include <rendercommands.hpp>
 
 extern World *currentWorld;
 
 Engine::Engine(void)
-    : gameRunning(true), systems(game::entities, game::events)
+    : gameRunning(true), emptyWorld(std::make_shared<WorldEntities>()), world(emptyWorld),
+      systems(emptyWorld->entities, game::events)
 {
 }
 
+void Engine::activateWorld(std::shared_ptr<WorldEntities> w)
+{
+	// hold on to the old world until the systems have let go of it
+	auto old = std::atomic_exchange(&world, w);
+
+	game::clearDirty();
+	game::events.emit<WorldActivateEvent>(w.get());
+}
+
 void Engine::init(void) {
     game::config::read();
     game::events.subscribe<GameEndEvent>(*this);
 
     systems.add<WindowSystem>();
     systems.add<RenderSystem>();
+    systems.add<LightSystem>();
 	systems.add<InputSystem>();
     systems.add<InventorySystem>();
     systems.add<WorldSystem>();
     systems.add<PlayerSystem>();
 	systems.add<PhysicsSystem>();
+	systems.add<ActivitySystem>();
 	systems.add<MovementSystem>();
+	systems.add<SnapshotSystem>();
 
     systems.configure();
 
+	game::profiler::addSection("component pools", [](std::ostream& out) {
+		for (const auto& p : game::pools::getStats()) {
+			out << p.name << ": " << p.live << " live, " << p.capacity << " slots, "
+			    << p.holes << " holes, " << p.bytes << " bytes\n";
+		}
+	});
+
+	// let the systems hook up to the (empty) starting world
+	game::events.emit<WorldActivateEvent>(emptyWorld.get());
+
 	game::config::update();
 }
 
 void Engine::render(entityx::TimeDelta dt)
 {
-    systems.update<RenderSystem>(dt);
-	systems.update<WindowSystem>(dt);
-    systems.update<InventorySystem>(dt);
+	PROFILE_SCOPE("engine render");
+
+	updateSystem<LightSystem>(dt);
+    updateSystem<RenderSystem>(dt);
+	updateSystem<WindowSystem>(dt);
+    updateSystem<InventorySystem>(dt);
 
 	ui::fadeUpdate();
 }
 
 void Engine::update(entityx::TimeDelta dt)
 {
-    systems.update<InputSystem>(dt);
-	//systems.update<PhysicsSystem>(dt);
-	systems.update<MovementSystem>(dt);
-	systems.update<WorldSystem>(dt);
-    systems.update<PlayerSystem>(dt);
+	PROFILE_SCOPE("engine update");
+
+    updateSystem<InputSystem>(dt);
+	updateSystem<ActivitySystem>(dt);
+	//updateSystem<PhysicsSystem>(dt);
+	updateSystem<MovementSystem>(dt);
+	updateSystem<WorldSystem>(dt);
+    updateSystem<PlayerSystem>(dt);
+
+	// apply what other threads queued up, now that nothing is iterating
+	game::playCommands(getWorld()->entities);
+
+	updateSystem<SnapshotSystem>(dt);
+
+	// pool stats don't change fast enough to be worth measuring every frame
+	if (game::time::getFrameCount() % POOL_MEASURE_INTERVAL == 0)
+		game::pools::measure(getWorld()->entities);
+
+	// anything drawn from this thread goes out with the next frame
+	Render::handOverCommands();
+
+	// start a new frame for change tracking
+	game::time::nextFrame();
 }
 
 
 namespace game {
 	entityx::EventManager events;
-	entityx::EntityManager entities (events);
 	SpriteLoader sprite_l;
 
     Engine engine;
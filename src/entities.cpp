@@ -6,11 +6,13 @@
 
 void entityxTest(void)
 {
-	entityx::Entity e = game::entities.create();
+	auto& entities = game::engine.getWorld()->entities;
+
+	entityx::Entity e = entities.create();
 	e.assign<Position>(100.0f, 100.0f);
 	e.assign<Direction>(0.0f, 0.0f);
 
-	e = game::entities.create();
+	e = entities.create();
 	e.assign<Position>(0.0f, 100.0f);
 	e.assign<Direction>(-0.01f, 0.0f);
 	e.assign<Physics>(-0.001f);
@@ -20,5 +22,31 @@ void entityxTest(void)
 										  vec2(0, 0)),
 										  vec2(0, 0));
 
+	e.assign<CameraTarget>();
+
 	game::engine.getSystem<PlayerSystem>()->setPlayer(e);
 }
+
+template<typename... Cs>
+static void copyComponents(entityx::Entity from, entityx::Entity to)
+{
+	int copy[] = {
+		0,
+		(from.has_component<Cs>() ? (to.assign_from_copy<Cs>(*from.component<Cs>().get()), 0) : 0)...
+	};
+	(void)copy;
+}
+
+entityx::Entity copyEntity(entityx::Entity e, entityx::EntityManager &to)
+{
+	auto copy = to.create();
+	copyComponents<Position, Direction, Physics, Health, Solid, Sprite, Animate, Input, Visible, CameraTarget, Light>(e, copy);
+	return copy;
+}
+
+entityx::Entity moveEntity(entityx::Entity e, entityx::EntityManager &to)
+{
+	auto moved = copyEntity(e, to);
+	e.destroy();
+	return moved;
+}
@@ -3,6 +3,7 @@
 #include <common.hpp>
 
 static unsigned int tickCount = 0;
+static unsigned int frameCount = 1;
 static float deltaTime = 1;
 
 // millisecond timers
@@ -51,5 +52,13 @@ namespace game {
 
             return false;
         }
+
+        unsigned int getFrameCount(void) {
+            return frameCount;
+        }
+
+        void nextFrame(void) {
+            frameCount++;
+        }
     }
 }
@@ -0,0 +1,362 @@
+#include <glyphcache.hpp>
+
+#include <render.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+
+Glyph GlyphCache::get(FT_Face face, unsigned int size, char32_t code)
+{
+	// fields are made at one size; drawing them at another just scales them
+	float scale = static_cast<float>(size) / GLYPH_SDF_SIZE;
+	auto scaled = [scale](Glyph g) {
+		g.wh = vec2(g.wh.x * scale, g.wh.y * scale);
+		g.bl = vec2(g.bl.x * scale, g.bl.y * scale);
+		g.ad = vec2(g.ad.x * scale, g.ad.y * scale);
+		return g;
+	};
+
+	Key key {face, code};
+
+	auto found = entries.find(key);
+	if (found != entries.end()) {
+		auto& e = found->second;
+		e.lastUsed = frame;
+		lru.splice(lru.begin(), lru, e.lru);
+		return scaled(e.glyph);
+	}
+
+	Glyph glyph {0, vec2(0, 0), vec2(0, 0), vec2(0, 0), vec2(0, 0), vec2(0, 0)};
+
+	Field field;
+	if (!render(face, code, field))
+		return glyph;
+
+	glyph.wh = vec2(field.w, field.h);
+	glyph.bl = field.bl;
+	glyph.ad = field.ad;
+
+	// blank glyphs (like spaces) take no room
+	Slot slot {0, 0, 0, 0, 0};
+	if (field.w > 0 && field.h > 0) {
+		// if nothing can be freed up, skip drawing it and try again next frame
+		if (!place(field.w + GLYPH_PADDING, field.h + GLYPH_PADDING, slot) &&
+		    !evict(field.w + GLYPH_PADDING, field.h + GLYPH_PADDING, slot))
+			return scaled(glyph);
+
+		upload(slot, field);
+
+		// the field's top row is at the slot's top, but quads are drawn from the bottom up
+		glyph.tex = pages[slot.page].tex;
+		glyph.uv0 = vec2(static_cast<float>(slot.x) / GLYPH_PAGE_SIZE, static_cast<float>(slot.y + field.h) / GLYPH_PAGE_SIZE);
+		glyph.uv1 = vec2(static_cast<float>(slot.x + field.w) / GLYPH_PAGE_SIZE, static_cast<float>(slot.y) / GLYPH_PAGE_SIZE);
+	}
+
+	lru.push_front(key);
+	entries.emplace(key, Entry {glyph, slot, frame, lru.begin()});
+	return scaled(glyph);
+}
+
+/**
+ * Names a face in a way that's the same from run to run.
+ */
+static std::string faceName(FT_Face face)
+{
+	return std::string(face->family_name != nullptr ? face->family_name : "") + ' ' +
+	       (face->style_name != nullptr ? face->style_name : "");
+}
+
+/**
+ * Makes a distance field from a glyph's coverage. Texels hold 0.5 on the
+ * outline, rising inside the glyph and falling outside, reaching 0 or 1 at
+ * GLYPH_SDF_SPREAD pixels away.
+ */
+static void makeField(const FT_Bitmap& bitmap, int& w, int& h, std::vector<uint8_t>& data)
+{
+	const int spread = GLYPH_SDF_SPREAD;
+	w = bitmap.width + spread * 2;
+	h = bitmap.rows + spread * 2;
+
+	std::vector<bool> inside (w * h, false);
+	for (unsigned int r = 0; r < bitmap.rows; r++) {
+		for (unsigned int c = 0; c < bitmap.width; c++)
+			inside[(r + spread) * w + c + spread] = bitmap.buffer[r * bitmap.pitch + c] >= 128;
+	}
+
+	data.resize(w * h);
+	for (int y = 0; y < h; y++) {
+		for (int x = 0; x < w; x++) {
+			bool in = inside[y * w + x];
+
+			// the nearest texel on the other side of the outline
+			int best = (spread + 1) * (spread + 1);
+			for (int dy = -spread; dy <= spread; dy++) {
+				for (int dx = -spread; dx <= spread; dx++) {
+					int nx = x + dx, ny = y + dy;
+					bool other = (nx >= 0 && ny >= 0 && nx < w && ny < h) ? inside[ny * w + nx] : false;
+					if (other != in)
+						best = std::min(best, dx * dx + dy * dy);
+				}
+			}
+
+			// the outline is halfway between the two texels
+			float dist = std::min(std::sqrt(static_cast<float>(best)), static_cast<float>(spread)) - 0.5f;
+			float value = 0.5f + (in ? dist : -dist) / (spread * 2);
+			data[y * w + x] = static_cast<uint8_t>(std::max(0.0f, std::min(1.0f, value)) * 255 + 0.5f);
+		}
+	}
+}
+
+bool GlyphCache::render(FT_Face face, char32_t code, Field& field)
+{
+	if (!cacheLoaded)
+		loadCache();
+
+	auto name = faceName(face) + '/' + std::to_string(code);
+	auto found = stored.find(name);
+	if (found != stored.end()) {
+		field = found->second;
+		return true;
+	}
+
+	// setting the size makes FreeType redo its metrics, so only do it if needed
+	if (face != lastFace) {
+		FT_Set_Pixel_Sizes(face, 0, GLYPH_SDF_SIZE);
+		lastFace = face;
+	}
+
+	// characters the face doesn't have come out as its 'missing' glyph
+	if (FT_Load_Char(face, code, FT_LOAD_RENDER))
+		return false;
+
+	const auto& g = *face->glyph;
+	field.ad = vec2(g.advance.x >> 6, g.advance.y >> 6);
+
+	if (g.bitmap.width == 0 || g.bitmap.rows == 0) {
+		field.w = field.h = 0;
+		field.bl = vec2(g.bitmap_left, g.bitmap_top);
+	} else {
+		makeField(g.bitmap, field.w, field.h, field.data);
+		field.bl = vec2(g.bitmap_left - GLYPH_SDF_SPREAD, g.bitmap_top + GLYPH_SDF_SPREAD);
+	}
+
+	stored.emplace(name, field);
+	appendCache(name, field);
+	return true;
+}
+
+bool GlyphCache::place(int w, int h, Slot& slot)
+{
+	// shelves come in heights of eight, so freed slots suit more glyphs
+	int sh = (h + 7) & ~7;
+
+	// slots let go by forget() are as good as new
+	for (auto it = freed.begin(); it != freed.end(); ++it) {
+		if (it->w >= w && it->h >= h) {
+			slot = *it;
+			freed.erase(it);
+			return true;
+		}
+	}
+
+	for (unsigned int pi = 0; pi < pages.size(); pi++) {
+		auto& p = pages[pi];
+
+		for (auto& s : p.shelves) {
+			if (s.h == sh && s.x + w <= GLYPH_PAGE_SIZE) {
+				slot = Slot {pi, s.x, s.y, w, sh};
+				s.x += w;
+				return true;
+			}
+		}
+
+		if (p.top + sh <= GLYPH_PAGE_SIZE) {
+			p.shelves.push_back(Shelf {p.top, sh, w});
+			slot = Slot {pi, 0, p.top, w, sh};
+			p.top += sh;
+			return true;
+		}
+	}
+
+	if (pages.size() >= GLYPH_MAX_PAGES || sh > GLYPH_PAGE_SIZE || w > GLYPH_PAGE_SIZE)
+		return false;
+
+	// start a new, empty page
+	Page p {0, { Shelf {0, sh, w} }, sh};
+
+	std::vector<uint32_t> clear (GLYPH_PAGE_SIZE * GLYPH_PAGE_SIZE, 0);
+	glGenTextures(1, &p.tex);
+	Render::state::bindTexture(p.tex);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, GLYPH_PAGE_SIZE, GLYPH_PAGE_SIZE, 0,
+	             GL_RGBA, GL_UNSIGNED_BYTE, clear.data());
+
+	pages.push_back(p);
+	slot = Slot {static_cast<unsigned int>(pages.size() - 1), 0, 0, w, sh};
+	return true;
+}
+
+bool GlyphCache::evict(int w, int h, Slot& slot)
+{
+	// oldest first; anything used this frame may still be queued for drawing
+	for (auto it = lru.rbegin(); it != lru.rend(); ++it) {
+		auto found = entries.find(*it);
+		const auto& e = found->second;
+
+		if (e.lastUsed == frame)
+			break;
+
+		if (e.slot.w >= w && e.slot.h >= h) {
+			slot = e.slot;
+			lru.erase(e.lru);
+			entries.erase(found);
+			evictions++;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void GlyphCache::upload(const Slot& slot, const Field& field)
+{
+	// the field goes in the alpha, and the rest of the slot is cleared of
+	// whatever glyph had it before
+	std::vector<uint32_t> buf (slot.w * slot.h, 0x00FFFFFF);
+
+	for (int r = 0; r < field.h; r++) {
+		for (int c = 0; c < field.w; c++)
+			buf[r * slot.w + c] = 0x00FFFFFF | (static_cast<uint32_t>(field.data[r * field.w + c]) << 24);
+	}
+
+	Render::state::bindTexture(pages[slot.page].tex);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, slot.x, slot.y, slot.w, slot.h, GL_RGBA, GL_UNSIGNED_BYTE, buf.data());
+}
+
+void GlyphCache::writeField(std::ostream& out, const std::string& name, const Field& field)
+{
+	uint16_t len = name.size();
+	int32_t wh[2] = {field.w, field.h};
+	float m[4] = {field.bl.x, field.bl.y, field.ad.x, field.ad.y};
+
+	out.write(reinterpret_cast<const char *>(&len), sizeof(len));
+	out.write(name.data(), len);
+	out.write(reinterpret_cast<const char *>(wh), sizeof(wh));
+	out.write(reinterpret_cast<const char *>(m), sizeof(m));
+	out.write(reinterpret_cast<const char *>(field.data.data()), field.data.size());
+}
+
+void GlyphCache::loadCache(void)
+{
+	cacheLoaded = true;
+
+	std::ifstream in (GLYPH_CACHE_FILE, std::ios::binary);
+	std::string line;
+
+	// fields made with other settings are no good
+	unsigned int size = 0;
+	int spread = 0;
+	if (!std::getline(in, line) || std::sscanf(line.c_str(), "glyphs %u %d", &size, &spread) != 2 ||
+	    size != GLYPH_SDF_SIZE || spread != GLYPH_SDF_SPREAD)
+		return;
+
+	cacheValid = true;
+
+	uint16_t len;
+	while (in.read(reinterpret_cast<char *>(&len), sizeof(len))) {
+		std::string name (len, '\0');
+		int32_t wh[2];
+		float m[4];
+
+		in.read(&name[0], len);
+		in.read(reinterpret_cast<char *>(wh), sizeof(wh));
+		in.read(reinterpret_cast<char *>(m), sizeof(m));
+		if (!in || wh[0] < 0 || wh[1] < 0 || wh[0] > GLYPH_PAGE_SIZE || wh[1] > GLYPH_PAGE_SIZE) {
+			cacheValid = false;
+			break;
+		}
+
+		Field f {wh[0], wh[1], vec2(m[0], m[1]), vec2(m[2], m[3]), std::vector<uint8_t> (wh[0] * wh[1])};
+		if (!in.read(reinterpret_cast<char *>(f.data.data()), f.data.size())) {
+			cacheValid = false;
+			break;
+		}
+
+		stored[name] = std::move(f);
+	}
+}
+
+void GlyphCache::appendCache(const std::string& name, const Field& field)
+{
+	// a file that's missing, stale or cut short is written over in full
+	if (!cacheValid) {
+		std::ofstream out (GLYPH_CACHE_FILE, std::ios::binary | std::ios::trunc);
+		out << "glyphs " << GLYPH_SDF_SIZE << ' ' << GLYPH_SDF_SPREAD << '\n';
+		for (const auto& f : stored)
+			writeField(out, f.first, f.second);
+
+		cacheValid = static_cast<bool>(out);
+		return;
+	}
+
+	std::ofstream out (GLYPH_CACHE_FILE, std::ios::binary | std::ios::app);
+	writeField(out, name, field);
+}
+
+void GlyphCache::forget(FT_Face face)
+{
+	for (auto it = entries.begin(); it != entries.end();) {
+		if (it->first.face == face) {
+			if (it->second.slot.w > 0)
+				freed.push_back(it->second.slot);
+			lru.erase(it->second.lru);
+			it = entries.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	if (lastFace == face)
+		lastFace = nullptr;
+}
+
+namespace game {
+	char32_t nextCodepoint(const std::string& s, size_t& i)
+	{
+		auto c = static_cast<unsigned char>(s[i++]);
+		if (c < 0x80)
+			return c;
+
+		int more;
+		char32_t code;
+		if ((c & 0xE0) == 0xC0)
+			more = 1, code = c & 0x1F;
+		else if ((c & 0xF0) == 0xE0)
+			more = 2, code = c & 0x0F;
+		else if ((c & 0xF8) == 0xF0)
+			more = 3, code = c & 0x07;
+		else
+			return 0xFFFD;
+
+		for (; more > 0; more--) {
+			if (i >= s.size())
+				return 0;
+
+			auto cc = static_cast<unsigned char>(s[i]);
+			if ((cc & 0xC0) != 0x80)
+				return 0xFFFD;
+
+			code = (code << 6) | (cc & 0x3F);
+			i++;
+		}
+
+		return code;
+	}
+}
@@ -0,0 +1,131 @@
+#include <gputimer.hpp>
+
+#include <cstdio>
+#include <cstring>
+
+#include <config.hpp>
+#include <profiler.hpp>
+
+void GPUTimer::init(void)
+{
+	if (GLEW_VERSION_3_3 || GLEW_ARB_timer_query)
+		mode = Queries;
+	else if (game::config::GPU_TIMING_FINISH)
+		mode = Finish;
+	else
+		mode = Off;
+}
+
+GPUTimer::Pass& GPUTimer::find(const char *name)
+{
+	for (auto& p : passes) {
+		if (p.name == name || std::strcmp(p.name, name) == 0)
+			return p;
+	}
+
+	Pass p;
+	p.name = name;
+	p.label = std::string("gpu ") + name;
+	p.queries.fill(0);
+	p.issued.fill(false);
+	p.last = 0;
+
+	if (mode == Queries)
+		glGenQueries(GPU_TIMER_FRAMES, p.queries.data());
+
+	passes.push_back(p);
+	return passes.back();
+}
+
+void GPUTimer::begin(const char *name)
+{
+	if (mode == Off)
+		return;
+
+	if (current >= 0)
+		end();
+
+	auto& p = find(name);
+	current = &p - passes.data();
+
+	if (mode == Queries) {
+		// a result still unread from the last time this slot was used is dropped
+		glBeginQuery(GL_TIME_ELAPSED, p.queries[frame]);
+		p.issued[frame] = true;
+	} else {
+		glFinish();
+		start = std::chrono::steady_clock::now();
+	}
+}
+
+void GPUTimer::end(void)
+{
+	if (current < 0)
+		return;
+
+	auto& p = passes[current];
+	current = -1;
+
+	if (mode == Queries) {
+		glEndQuery(GL_TIME_ELAPSED);
+	} else {
+		glFinish();
+		auto now = std::chrono::steady_clock::now();
+		p.last = std::chrono::duration<double, std::milli>(now - start).count();
+		game::profiler::record(p.label.c_str(), p.last);
+	}
+}
+
+void GPUTimer::collect(unsigned int slot)
+{
+	for (auto& p : passes) {
+		if (!p.issued[slot])
+			continue;
+
+		p.issued[slot] = false;
+
+		// a frame late, these are almost always ready; if not, skip them
+		// rather than wait
+		GLint ready = 0;
+		glGetQueryObjectiv(p.queries[slot], GL_QUERY_RESULT_AVAILABLE, &ready);
+		if (!ready)
+			continue;
+
+		GLuint64 ns = 0;
+		glGetQueryObjectui64v(p.queries[slot], GL_QUERY_RESULT, &ns);
+		p.last = ns / 1000000.0;
+		game::profiler::record(p.label.c_str(), p.last);
+	}
+}
+
+void GPUTimer::endFrame(void)
+{
+	if (mode == Off)
+		return;
+
+	end();
+
+	// the next frame's queries were last used the frame before this one
+	frame = (frame + 1) % GPU_TIMER_FRAMES;
+	if (mode == Queries)
+		collect(frame);
+}
+
+std::string GPUTimer::getSummary(void) const
+{
+	std::string out;
+	char buf[16];
+
+	for (const auto& p : passes) {
+		std::snprintf(buf, sizeof(buf), " %.2f", p.last);
+		out += (out.empty() ? "" : ", ") + std::string(p.name) + buf;
+	}
+
+	return out;
+}
+
+namespace Render {
+
+GPUTimer gpuTimer;
+
+}
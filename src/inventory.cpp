@@ -7,7 +7,7 @@
 
 constexpr const char* ICON_TEX_FILE_PATH = "config/invIcons.txt";
 
-static std::vector<GLuint> iconTextures;
+static std::vector<SpriteHandle> iconSprites;
 
 void InventorySystem::configure(entityx::EventManager &ev)
 {
@@ -15,10 +15,10 @@ void InventorySystem::configure(entityx::EventManager &ev)
 }
 
 void InventorySystem::loadIcons(void) {
-    iconTextures.clear();
+    iconSprites.clear();
     auto icons = readFileA(ICON_TEX_FILE_PATH);
     for (const auto& s : icons)
-        iconTextures.push_back(Texture::loadTexture(s));
+        iconSprites.push_back(game::sprite_l.loadSprite(s));
 }
 
 void InventorySystem::update(entityx::EntityManager &en, entityx::EventManager &ev, entityx::TimeDelta dt)
@@ -33,8 +33,8 @@ void InventorySystem::update(entityx::EntityManager &en, entityx::EventManager &
     //std::cout << start.x << ' ' << start.y << std::endl;
 
     Render::textShader.use();
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, color);
+        Render::state::activeTexture(GL_TEXTURE0);
+        Render::state::bindTexture(color);
         Render::useShader(&Render::textShader);
         Render::drawRect(start, start + 20, -9.9f);
     Render::textShader.unuse();
@@ -0,0 +1,276 @@
+#include <lights.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include <activity.hpp>
+#include <components.hpp>
+#include <config.hpp>
+#include <engine.hpp>
+#include <gputimer.hpp>
+#include <render.hpp>
+#include <streambuffer.hpp>
+
+namespace {
+	struct Gathered {
+		vec2 loc;
+		float radius;
+		Color color;
+		float dist;
+	};
+}
+
+static std::vector<Gathered> gathered;
+
+void LightSystem::update(entityx::EntityManager &en, entityx::EventManager &ev, entityx::TimeDelta dt)
+{
+	(void)en;
+	(void)ev;
+	(void)dt;
+
+	const float width = game::SCREEN_WIDTH;
+	const float height = game::SCREEN_HEIGHT;
+
+	tileOrigin = offset.x - width / 2;
+	tileWidth = width / LIGHT_TILE_COUNT;
+
+	// gather what reaches the screen, lighting from an entity's middle if it has a size
+	gathered.clear();
+	game::engine.getSystem<ActivitySystem>()->eachAwake<Light, Position>(
+		[&](entityx::Entity entity, Light &light, Position &pos) {
+		vec2 loc (pos.x, pos.y);
+		if (entity.has_component<Solid>()) {
+			auto dim = entity.component<Solid>();
+			loc.x += dim->width / 2;
+			loc.y += dim->height / 2;
+		}
+
+		if (light.radius <= 0 ||
+		    std::abs(loc.x - offset.x) > light.radius + width / 2 ||
+		    std::abs(loc.y - offset.y) > light.radius + height / 2)
+			return;
+
+		gathered.push_back(Gathered {loc, light.radius, light.color, std::abs(loc.x - offset.x)});
+	});
+
+	// with too many, keep the ones nearest the middle of the screen
+	dropped = 0;
+	if (gathered.size() > LIGHT_MAX) {
+		std::nth_element(gathered.begin(), gathered.begin() + LIGHT_MAX, gathered.end(),
+		                 [](const Gathered& a, const Gathered& b) { return a.dist < b.dist; });
+		dropped = gathered.size() - LIGHT_MAX;
+		gathered.resize(LIGHT_MAX);
+	}
+
+	// bigger lights get listed first, so a full tile loses its smallest ones
+	std::sort(gathered.begin(), gathered.end(),
+	          [](const Gathered& a, const Gathered& b) { return a.radius > b.radius; });
+
+	lights.clear();
+	colors.clear();
+	for (const auto& g : gathered) {
+		lights.insert(lights.end(), {g.loc.x, g.loc.y, 0.0f, g.radius});
+		colors.insert(colors.end(), {g.color.red, g.color.green, g.color.blue, g.color.alpha});
+	}
+
+	if (game::config::LIGHT_BUFFER && makeBuffer()) {
+		drawBuffer();
+	} else {
+		bufferView.fill(0);
+		bin();
+		upload();
+	}
+}
+
+void LightSystem::bin(void)
+{
+	tiles.fill(0);
+
+	for (unsigned int i = 0; i < lights.size() / 4; i++) {
+		float x = lights[i * 4], r = lights[i * 4 + 3];
+
+		int first = std::max(static_cast<int>(std::floor((x - r - tileOrigin) / tileWidth)), 0);
+		int last = std::min(static_cast<int>(std::floor((x + r - tileOrigin) / tileWidth)),
+		                    static_cast<int>(LIGHT_TILE_COUNT) - 1);
+
+		for (int t = first; t <= last; t++) {
+			auto& count = tiles[t];
+			if (count == LIGHT_TILE_MAX) {
+				dropped++;
+				continue;
+			}
+
+			count++;
+			tiles[count * LIGHT_TILE_COUNT + t] = i;
+		}
+	}
+}
+
+void LightSystem::upload(void)
+{
+	Render::state::activeTexture(LIGHT_TILE_UNIT);
+
+	if (tileTex == 0) {
+		glGenTextures(1, &tileTex);
+		Render::state::bindTexture(tileTex);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, LIGHT_TILE_COUNT, LIGHT_TILE_MAX + 1, 0,
+		             GL_LUMINANCE, GL_UNSIGNED_BYTE, nullptr);
+	}
+
+	Render::state::bindTexture(tileTex);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, LIGHT_TILE_COUNT, LIGHT_TILE_MAX + 1,
+	                GL_LUMINANCE, GL_UNSIGNED_BYTE, tiles.data());
+	Render::state::activeTexture(GL_TEXTURE0);
+
+	// both shaders light with world.frag, so both get the same lights
+	for (auto *shader : { &Render::worldShader, &Render::grassShader }) {
+		shader->use();
+
+		auto count = lights.size() / 4;
+		if (count > 0) {
+			Render::state::uniform4fv(shader->uniform[WU_light], count, lights.data());
+			Render::state::uniform4fv(shader->uniform[WU_light_color], count, colors.data());
+		}
+		Render::state::uniform1i(shader->uniform[WU_light_size], count);
+		Render::state::uniform1i(shader->uniform[WU_light_tiles], LIGHT_TILE_UNIT - GL_TEXTURE0);
+		Render::state::uniform4f(shader->uniform[WU_light_tile_info], tileOrigin, tileWidth,
+		                         LIGHT_TILE_COUNT, LIGHT_TILE_MAX + 1);
+		Render::state::uniform4f(shader->uniform[WU_light_buffer_view], 0, 0, 0, 0);
+	}
+}
+
+bool LightSystem::makeBuffer(void)
+{
+	if (bufferFBO != 0)
+		return true;
+	if (bufferFailed)
+		return false;
+
+	// only try once; if it doesn't work out, the tiles will do
+	bufferFailed = true;
+
+	if (!GLEW_VERSION_3_0 && !GLEW_ARB_framebuffer_object) {
+		SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_WARN,
+		               "No framebuffer objects, lighting without the light buffer");
+		return false;
+	}
+
+	bufferWidth = std::max(game::SCREEN_WIDTH / LIGHT_BUFFER_SCALE, 1u);
+	bufferHeight = std::max(game::SCREEN_HEIGHT / LIGHT_BUFFER_SCALE, 1u);
+
+	glGenTextures(1, &bufferTex);
+	Render::state::activeTexture(LIGHT_BUFFER_UNIT);
+	Render::state::bindTexture(bufferTex);
+
+	// linear filtering is what smooths the buffer back up to the screen's size
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	// overlapping lights add up past 1, which only a float buffer keeps
+	GLint format = GLEW_ARB_texture_float ? GL_RGBA16F_ARB : GL_RGBA8;
+	glTexImage2D(GL_TEXTURE_2D, 0, format, bufferWidth, bufferHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+	glGenFramebuffers(1, &bufferFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, bufferFBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, bufferTex, 0);
+	auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	Render::state::activeTexture(GL_TEXTURE0);
+
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+		SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_WARN,
+		               "Light buffer incomplete (0x%x), lighting without it", status);
+		glDeleteFramebuffers(1, &bufferFBO);
+		Render::state::deleteTextures(1, &bufferTex);
+		bufferFBO = bufferTex = 0;
+		return false;
+	}
+
+	bufferFailed = false;
+	return true;
+}
+
+void LightSystem::drawBuffer(void)
+{
+	GPU_PASS("lights");
+
+	const float width = game::SCREEN_WIDTH;
+	const float height = game::SCREEN_HEIGHT;
+
+	bufferView = {{offset.x - width / 2, offset.y - height / 2, width, height}};
+
+	// a quad around each light, its corners at (0, 0) and (1, 1) for the falloff
+	bufferVerts.clear();
+	for (unsigned int i = 0; i < lights.size() / 4; i++) {
+		float x = lights[i * 4], y = lights[i * 4 + 1], r = lights[i * 4 + 3];
+		const GLfloat *c = &colors[i * 4];
+
+		GLfloat quad[6][8] = {
+			{x - r, y - r, 0, 0, c[0], c[1], c[2], c[3]},
+			{x + r, y - r, 1, 0, c[0], c[1], c[2], c[3]},
+			{x + r, y + r, 1, 1, c[0], c[1], c[2], c[3]},
+
+			{x + r, y + r, 1, 1, c[0], c[1], c[2], c[3]},
+			{x - r, y + r, 0, 1, c[0], c[1], c[2], c[3]},
+			{x - r, y - r, 0, 0, c[0], c[1], c[2], c[3]}
+		};
+
+		bufferVerts.insert(bufferVerts.end(), &quad[0][0], &quad[0][0] + 6 * 8);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, bufferFBO);
+	glViewport(0, 0, bufferWidth, bufferHeight);
+	glClearColor(0, 0, 0, 0);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	if (!bufferVerts.empty()) {
+		auto& shader = Render::lightShader;
+		shader.use();
+		Render::state::uniform4f(shader.uniform[LU_view], bufferView[0], bufferView[1], bufferView[2], bufferView[3]);
+
+		Render::state::disable(GL_DEPTH_TEST);
+		glBlendFunc(GL_ONE, GL_ONE);
+
+		auto base = Render::stream.push(bufferVerts.data(), bufferVerts.size() * sizeof(GLfloat));
+
+		shader.enable();
+		Render::state::enableAttrib(shader.color);
+
+		const auto stride = 8 * sizeof(GLfloat);
+		glVertexAttribPointer(shader.coord, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(base));
+		glVertexAttribPointer(shader.tex, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(base + 2 * sizeof(GLfloat)));
+		glVertexAttribPointer(shader.color, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(base + 4 * sizeof(GLfloat)));
+		glDrawArrays(GL_TRIANGLES, 0, bufferVerts.size() / 8);
+
+		Render::state::disableAttrib(shader.color);
+		shader.disable();
+
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		Render::state::enable(GL_DEPTH_TEST);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, game::SCREEN_WIDTH, game::SCREEN_HEIGHT);
+	glClearColor(1, 1, 1, 1);
+
+	Render::state::activeTexture(LIGHT_BUFFER_UNIT);
+	Render::state::bindTexture(bufferTex);
+	Render::state::activeTexture(GL_TEXTURE0);
+
+	for (auto *shader : { &Render::worldShader, &Render::grassShader }) {
+		shader->use();
+		Render::state::uniform1i(shader->uniform[WU_light_buffer], LIGHT_BUFFER_UNIT - GL_TEXTURE0);
+		Render::state::uniform4f(shader->uniform[WU_light_buffer_view], bufferView[0], bufferView[1],
+		                         bufferView[2], bufferView[3]);
+	}
+}
@@ -6,6 +6,7 @@
 #include <gametime.hpp>
 #include <world.hpp>
 #include <components.hpp>
+#include <dirty.hpp>
 
 void PlayerSystem::configure(entityx::EventManager &ev)
 {
@@ -62,8 +63,9 @@ void PlayerSystem::receive(const KeyUpEvent &kue)
 void PlayerSystem::receive(const KeyDownEvent &kde)
 {
 	auto kc = kde.keycode;
-	auto& loc = *game::entities.get(pid).component<Position>().get();
-    auto& faceLeft = game::entities.get(pid).component<Sprite>().get()->faceLeft;
+	auto player = game::engine.getWorld()->entities.get(pid);
+	auto& loc = game::write<Position>(player);
+    auto& faceLeft = game::write<Sprite>(player).faceLeft;
 
 	/*auto worldSwitch = [&](const WorldSwitchInfo& wsi){
 		player->canMove = false;
@@ -145,6 +147,10 @@ void PlayerSystem::receive(const KeyDownEvent &kde)
 
 vec2 PlayerSystem::getPosition(void) const
 {
-    auto loc = *game::entities.get(pid).component<Position>().get();
-    return vec2 {loc.x, loc.y};
+    auto world = game::engine.getWorld();
+    if (!world->entities.valid(pid))
+        return vec2 {0, 0};
+
+    auto loc = world->entities.get(pid).component<Position>();
+    return loc ? vec2 {loc->x, loc->y} : vec2 {0, 0};
 }
@@ -0,0 +1,85 @@
+#include <pools.hpp>
+
+#include <mutex>
+
+#include <components.hpp>
+#include <config.hpp>
+#include <engine.hpp>
+#include <entities.hpp>
+
+static std::mutex statsMutex;
+static std::vector<PoolStats> stats;
+
+template<typename C>
+struct Named {
+	using type = C;
+	const char *name;
+};
+
+// calls f with every component type there's a pool for
+template<typename F>
+static void eachType(F f)
+{
+	f(Named<Position>     {"Position"});
+	f(Named<Direction>    {"Direction"});
+	f(Named<Physics>      {"Physics"});
+	f(Named<Health>       {"Health"});
+	f(Named<Solid>        {"Solid"});
+	f(Named<Sprite>       {"Sprite"});
+	f(Named<Animate>      {"Animate"});
+	f(Named<Input>        {"Input"});
+	f(Named<Visible>      {"Visible"});
+	f(Named<CameraTarget> {"CameraTarget"});
+	f(Named<Light>        {"Light"});
+}
+
+namespace game {
+	namespace pools {
+		void measure(entityx::EntityManager &en) {
+			std::vector<PoolStats> measured;
+			auto capacity = en.capacity();
+			auto chunks = (capacity + POOL_CHUNK_SIZE - 1) / POOL_CHUNK_SIZE;
+
+			eachType([&](auto type) {
+				using C = typename decltype(type)::type;
+
+				size_t live = 0;
+				for (auto e : en.entities_for_debugging())
+					live += e.has_component<C>() ? 1 : 0;
+
+				// a pool is only made once something has the component
+				auto bytes = (live > 0) ? chunks * POOL_CHUNK_SIZE * sizeof(C) : 0;
+				measured.push_back(PoolStats {type.name, live, capacity, bytes, capacity - live});
+			});
+
+			std::lock_guard<std::mutex> lock (statsMutex);
+			stats = std::move(measured);
+		}
+
+		std::vector<PoolStats> getStats(void) {
+			std::lock_guard<std::mutex> lock (statsMutex);
+			return stats;
+		}
+
+		bool needsCompaction(entityx::EntityManager &en) {
+			auto capacity = en.capacity();
+			auto free = capacity - en.size();
+
+			return free >= config::POOL_COMPACT_MIN &&
+			       free >= config::POOL_COMPACT_RATIO * capacity;
+		}
+
+		std::shared_ptr<WorldEntities> compact(WorldEntities &w,
+			std::unordered_map<entityx::Entity::Id, entityx::Entity::Id> *remap) {
+			auto packed = std::make_shared<WorldEntities>();
+
+			for (auto e : w.entities.entities_for_debugging()) {
+				auto copy = copyEntity(e, packed->entities);
+				if (remap != nullptr)
+					remap->emplace(e.id(), copy.id());
+			}
+
+			return packed;
+		}
+	}
+}
@@ -0,0 +1,78 @@
+#include <profiler.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <vector>
+
+struct Timing {
+	unsigned int calls;
+	double total;
+	double last;
+	double worst;
+};
+
+static std::mutex profMutex;
+static std::map<std::string, Timing> timings;
+static std::vector<std::pair<std::string, std::function<void(std::ostream&)>>> sections;
+
+namespace game {
+	namespace profiler {
+		Scope::~Scope(void) {
+			auto end = std::chrono::steady_clock::now();
+			record(name, std::chrono::duration<double, std::milli>(end - start).count());
+		}
+
+		void record(const char *name, double ms) {
+			std::lock_guard<std::mutex> lock (profMutex);
+
+			auto& t = timings[name];
+			t.calls++;
+			t.total += ms;
+			t.last = ms;
+			t.worst = std::max(t.worst, ms);
+		}
+
+		double getLast(const char *name) {
+			std::lock_guard<std::mutex> lock (profMutex);
+
+			auto found = timings.find(name);
+			return (found != timings.end()) ? found->second.last : 0.0;
+		}
+
+		void addSection(const std::string& name, std::function<void(std::ostream&)> f) {
+			std::lock_guard<std::mutex> lock (profMutex);
+			sections.emplace_back(name, f);
+		}
+
+		void dump(std::ostream& out) {
+			std::lock_guard<std::mutex> lock (profMutex);
+
+			out << std::fixed << std::setprecision(3);
+			out << "== timings (ms) ==\n";
+			for (const auto& t : timings) {
+				out << std::left << std::setw(24) << t.first
+				    << " calls " << std::setw(8) << t.second.calls
+				    << " avg " << std::setw(8) << t.second.total / t.second.calls
+				    << " last " << std::setw(8) << t.second.last
+				    << " worst " << t.second.worst << '\n';
+			}
+
+			for (const auto& s : sections) {
+				out << "\n== " << s.first << " ==\n";
+				s.second(out);
+			}
+		}
+
+		bool dump(const std::string& file) {
+			std::ofstream out (file);
+			if (!out.good())
+				return false;
+
+			dump(out);
+			return out.good();
+		}
+	}
+}
@@ -1,11 +1,280 @@
 #include <render.hpp>
+#include <config.hpp>
+#include <streambuffer.hpp>
+
+#include <array>
+#include <bitset>
+#include <cstring>
+#include <unordered_map>
 
 static Shader *currentShader = nullptr;
 
 namespace Render {
+namespace state {
+
+// state nobody's set through here yet, so the first call always goes through
+constexpr const GLuint UNKNOWN = ~0u;
+
+constexpr const unsigned int MAX_UNITS = 8;
+constexpr const unsigned int MAX_ATTRIBS = 16;
+
+static GLuint program = UNKNOWN;
+static GLenum unit = UNKNOWN;
+static std::array<GLuint, MAX_UNITS> textures = [] {
+    std::array<GLuint, MAX_UNITS> t;
+    t.fill(UNKNOWN);
+    return t;
+}();
+
+static std::bitset<MAX_ATTRIBS> attribs;
+static std::bitset<MAX_ATTRIBS> attribsKnown;
+
+static std::unordered_map<GLenum, bool> caps;
+static GLint depthWrite = -1;
+
+// uniform values by program and location
+static std::unordered_map<uint64_t, std::array<GLfloat, 4>> uniforms;
+
+static Stats frame {0, 0};
+static Stats lastFrame {0, 0};
+
+// counts the call, and whether it can be skipped
+static inline bool changed(bool differs)
+{
+    if (differs)
+        frame.issued++;
+    else
+        frame.skipped++;
+
+    return differs;
+}
+
+void useProgram(GLuint p)
+{
+    if (changed(program != p)) {
+        glUseProgram(p);
+        program = p;
+    }
+}
+
+void activeTexture(GLenum u)
+{
+    if (changed(unit != u)) {
+        glActiveTexture(u);
+        unit = u;
+    }
+}
+
+void bindTexture(GLuint tex)
+{
+    // with no unit set yet, GL's default is the first
+    if (unit == UNKNOWN)
+        activeTexture(GL_TEXTURE0);
+
+    auto& bound = textures[(unit - GL_TEXTURE0) % MAX_UNITS];
+    if (changed(bound != tex)) {
+        glBindTexture(GL_TEXTURE_2D, tex);
+        bound = tex;
+    }
+}
+
+void deleteTextures(GLsizei n, const GLuint *tex)
+{
+    // GL unbinds deleted textures, and their names get handed out again
+    for (GLsizei i = 0; i < n; i++) {
+        for (auto& t : textures) {
+            if (t == tex[i])
+                t = 0;
+        }
+    }
+
+    glDeleteTextures(n, tex);
+}
+
+void enableAttrib(GLint attrib)
+{
+    if (attrib < 0 || attrib >= static_cast<GLint>(MAX_ATTRIBS)) {
+        glEnableVertexAttribArray(attrib);
+        return;
+    }
+
+    if (changed(!attribsKnown[attrib] || !attribs[attrib])) {
+        glEnableVertexAttribArray(attrib);
+        attribs[attrib] = true;
+        attribsKnown[attrib] = true;
+    }
+}
+
+void disableAttrib(GLint attrib)
+{
+    if (attrib < 0 || attrib >= static_cast<GLint>(MAX_ATTRIBS)) {
+        glDisableVertexAttribArray(attrib);
+        return;
+    }
+
+    if (changed(!attribsKnown[attrib] || attribs[attrib])) {
+        glDisableVertexAttribArray(attrib);
+        attribs[attrib] = false;
+        attribsKnown[attrib] = true;
+    }
+}
+
+void enable(GLenum cap)
+{
+    auto found = caps.find(cap);
+    if (changed(found == caps.end() || !found->second)) {
+        glEnable(cap);
+        caps[cap] = true;
+    }
+}
+
+void disable(GLenum cap)
+{
+    auto found = caps.find(cap);
+    if (changed(found == caps.end() || found->second)) {
+        glDisable(cap);
+        caps[cap] = false;
+    }
+}
+
+void depthMask(GLboolean flag)
+{
+    if (changed(depthWrite != flag)) {
+        glDepthMask(flag);
+        depthWrite = flag;
+    }
+}
+
+// checks a uniform's value against the last one set, remembering the new one
+static bool uniformChanged(GLint loc, const GLfloat *v, int n)
+{
+    // without a program (or a location) the call does nothing, so let GL say so
+    if (program == 0 || program == UNKNOWN || loc < 0)
+        return true;
+
+    std::array<GLfloat, 4> value {{0, 0, 0, 0}};
+    std::memcpy(value.data(), v, n * sizeof(GLfloat));
+
+    auto key = (static_cast<uint64_t>(program) << 32) | static_cast<uint32_t>(loc);
+    auto found = uniforms.find(key);
+    if (!changed(found == uniforms.end() || found->second != value))
+        return false;
+
+    uniforms[key] = value;
+    return true;
+}
+
+void uniform1i(GLint loc, GLint v)
+{
+    GLfloat f = v;
+    if (uniformChanged(loc, &f, 1))
+        glUniform1i(loc, v);
+}
+
+void uniform1f(GLint loc, GLfloat v)
+{
+    if (uniformChanged(loc, &v, 1))
+        glUniform1f(loc, v);
+}
+
+void uniform2f(GLint loc, GLfloat x, GLfloat y)
+{
+    GLfloat v[2] = {x, y};
+    if (uniformChanged(loc, v, 2))
+        glUniform2f(loc, x, y);
+}
+
+void uniform3f(GLint loc, GLfloat x, GLfloat y, GLfloat z)
+{
+    GLfloat v[3] = {x, y, z};
+    if (uniformChanged(loc, v, 3))
+        glUniform3f(loc, x, y, z);
+}
+
+void uniform4f(GLint loc, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
+{
+    GLfloat v[4] = {x, y, z, w};
+    if (uniformChanged(loc, v, 4))
+        glUniform4f(loc, x, y, z, w);
+}
+
+void uniform4fv(GLint loc, GLsizei count, const GLfloat *v)
+{
+    // only single vectors are worth remembering
+    if (count != 1 || uniformChanged(loc, v, 4))
+        glUniform4fv(loc, count, v);
+}
+
+void forgetProgram(GLuint p)
+{
+    for (auto it = uniforms.begin(); it != uniforms.end();) {
+        if ((it->first >> 32) == p)
+            it = uniforms.erase(it);
+        else
+            ++it;
+    }
+
+    if (program == p)
+        program = UNKNOWN;
+}
+
+void endFrame(void)
+{
+    lastFrame = frame;
+    frame = Stats {0, 0};
+}
+
+Stats getLastFrame(void)
+{
+    return lastFrame;
+}
+
+}
+}
+
+namespace Render {
+
+View getView(float margin)
+{
+    const float w = game::SCREEN_WIDTH / 2.0f + margin;
+    const float h = game::SCREEN_HEIGHT / 2.0f + margin;
+
+    return View {offset.x - w, offset.x + w, offset.y - h, offset.y + h, offset.x};
+}
+
+namespace cull {
+
+static std::array<Stats, CK_count> frame;
+static std::array<Stats, CK_count> lastFrame;
+
+bool test(CullKind kind, const View& view, vec2 loc, vec2 size, float parallax)
+{
+    bool seen = view.sees(loc, size, parallax);
+    if (seen)
+        frame[kind].drawn++;
+    else
+        frame[kind].culled++;
+    return seen;
+}
+
+void endFrame(void)
+{
+    lastFrame = frame;
+    frame.fill(Stats {0, 0});
+}
+
+Stats getLastFrame(CullKind kind)
+{
+    return lastFrame[kind];
+}
+
+}
 
 Shader worldShader;
+Shader grassShader;
 Shader textShader;
+Shader fontShader;
+Shader lightShader;
 
 void initShaders(void)
 {
@@ -20,6 +289,31 @@ void initShaders(void)
     worldShader.addUniform("light");
     worldShader.addUniform("lightColor");
     worldShader.addUniform("lightSize");
+    worldShader.addUniform("lightTiles");
+    worldShader.addUniform("lightTileInfo");
+    worldShader.addUniform("lightBuffer");
+    worldShader.addUniform("lightBufferView");
+    worldShader.addUniform("tex_offset");
+
+    // create the grass shader, which is the world shader with blades raised
+    // and swayed from a texture of per-column state
+    grassShader.create("shaders/grass.vert", "shaders/world.frag");
+    grassShader.addUniform("texture");
+    grassShader.addUniform("ortho");
+    grassShader.addUniform("tex_color");
+    grassShader.addUniform("transform");
+    grassShader.addUniform("ambientLight");
+    grassShader.addUniform("lightImpact");
+    grassShader.addUniform("light");
+    grassShader.addUniform("lightColor");
+    grassShader.addUniform("lightSize");
+    grassShader.addUniform("lightTiles");
+    grassShader.addUniform("lightTileInfo");
+    grassShader.addUniform("lightBuffer");
+    grassShader.addUniform("lightBufferView");
+    grassShader.addUniform("grass");
+    grassShader.addUniform("grass_size");
+    grassShader.addUniform("wind_time");
 
     // create the text shader
     textShader.create("shaders/new.vert", "shaders/new.frag");
@@ -27,6 +321,19 @@ void initShaders(void)
     textShader.addUniform("ortho"); // actually not used, ortho in new.vert is mislabeled (actually transform)
     textShader.addUniform("tex_color");
     textShader.addUniform("ortho"); // this is transform
+
+    // create the font shader, which draws distance field glyphs colored per vertex
+    fontShader.create("shaders/font.vert", "shaders/sdf.frag");
+    fontShader.addUniform("sampler");
+    fontShader.addUniform("ortho");
+    fontShader.addUniform("outline_color");
+    fontShader.addUniform("outline_width");
+    fontShader.addUniform("shadow_color");
+    fontShader.addUniform("shadow_offset");
+
+    // create the light shader, which adds lights up into the light buffer
+    lightShader.create("shaders/light.vert", "shaders/light.frag");
+    lightShader.addUniform("view");
 }
 
 void useShader(Shader *s)
@@ -52,11 +359,10 @@ void drawRect(vec2 ll, vec2 ur, float z)
                      0.0, 0.0,
                      0.0, 1.0};
 
-    glUniform1i(currentShader->uniform[WU_texture], 0);
+    state::uniform1i(currentShader->uniform[WU_texture], 0);
     currentShader->enable();
 
-    glVertexAttribPointer(currentShader->coord, 3, GL_FLOAT, GL_FALSE, 0, verts);
-    glVertexAttribPointer(currentShader->tex, 2, GL_FLOAT, GL_FALSE, 0, tex);
+    streamVertices(*currentShader, 6, verts, tex);
     glDrawArrays(GL_TRIANGLES, 0, 6);
 
     currentShader->disable();
@@ -0,0 +1,248 @@
+#include <rendercommands.hpp>
+#include <gputimer.hpp>
+
+#include <algorithm>
+#include <mutex>
+
+namespace Render {
+
+/* ----------------------------------------------------------------------------
+** Recording
+** --------------------------------------------------------------------------*/
+
+// key, from the top: pass (8 bits), shader (8), order (2), texture (30), depth (16)
+uint64_t CommandList::makeKey(RenderPass pass, const Shader& shader, Order order, GLuint tex, float z)
+{
+	// further back (larger z) draws first, from 10 at the back to -10 at the front
+	float d = std::min(std::max((10.0f - z) / 20.0f, 0.0f), 1.0f);
+
+	return (static_cast<uint64_t>(pass) << 56) |
+	       (static_cast<uint64_t>(shader.shader & 0xFF) << 48) |
+	       (static_cast<uint64_t>(order & 0x3) << 46) |
+	       (static_cast<uint64_t>(tex & 0x3FFFFFFF) << 16) |
+	       static_cast<uint64_t>(d * 0xFFFF);
+}
+
+Command& CommandList::add(Command::Type type, RenderPass pass, Shader& shader)
+{
+	commands.emplace_back();
+
+	auto& c = commands.back();
+	c.type = type;
+	c.pass = pass;
+	c.shader = &shader;
+	return c;
+}
+
+void CommandList::drawSprite(RenderPass pass, Shader& shader, GLuint tex, vec2 uv0, vec2 uv1,
+                             vec2 loc, vec2 size, float z, bool flip)
+{
+	auto& c = add(Command::DrawSprite, pass, shader);
+	c.key = makeKey(pass, shader, Quads, tex, z);
+	c.tex = tex;
+	c.uv0 = uv0, c.uv1 = uv1;
+	c.loc = loc, c.size = size;
+	c.z = z;
+	c.flip = flip;
+	std::fill(c.color, c.color + 4, 255);
+}
+
+void CommandList::drawText(RenderPass pass, Shader& shader, GLuint tex, vec2 uv0, vec2 uv1,
+                           vec2 loc, vec2 size, float z, const GLubyte *color)
+{
+	drawSprite(pass, shader, tex, uv0, uv1, loc, size, z);
+
+	auto& c = commands.back();
+	c.type = Command::DrawText;
+	std::copy(color, color + 4, c.color);
+}
+
+void CommandList::drawMesh(RenderPass pass, Shader& shader, GLuint vbo, GLint first, GLsizei count,
+                           GLuint tex, float z)
+{
+	auto& c = add(Command::DrawMesh, pass, shader);
+	c.key = makeKey(pass, shader, Meshes, tex, z);
+	c.tex = tex;
+	c.vbo = vbo;
+	c.first = first;
+	c.count = count;
+}
+
+void CommandList::setUniform(RenderPass pass, Shader& shader, unsigned int uniform,
+                             const GLfloat *value, unsigned int n)
+{
+	auto& c = add(Command::SetUniform, pass, shader);
+	c.key = makeKey(pass, shader, Uniforms, 0, 10.0f);
+	c.uniform = uniform;
+	c.n = std::min(n, 4u);
+	std::copy(value, value + c.n, c.value);
+}
+
+void CommandList::sort(void)
+{
+	// stable, so uniforms keep the order they were set in
+	std::stable_sort(commands.begin(), commands.end(), [](const Command& a, const Command& b) {
+		return a.key < b.key;
+	});
+}
+
+/* ----------------------------------------------------------------------------
+** Backends
+** --------------------------------------------------------------------------*/
+
+void GLBackend::begin(RenderPass pass, Shader& shader)
+{
+	shader.use();
+	Render::state::activeTexture(GL_TEXTURE0);
+
+	if (pass == RP_text)
+		Render::state::depthMask(GL_FALSE);
+}
+
+void GLBackend::end(RenderPass pass, Shader& shader)
+{
+	batch.flush(shader);
+	stats.draws[pass] += batch.getDrawCount();
+
+	if (pass == RP_text)
+		Render::state::depthMask(GL_TRUE);
+}
+
+void GLBackend::drawMesh(const Command& c)
+{
+	auto& shader = *c.shader;
+
+	glBindBuffer(GL_ARRAY_BUFFER, c.vbo);
+	Render::state::uniform1i(shader.uniform[WU_texture], 0);
+	Render::state::bindTexture(c.tex);
+	shader.enable();
+
+	glVertexAttribPointer(shader.coord, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), reinterpret_cast<void *>(0));
+	glVertexAttribPointer(shader.tex, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), reinterpret_cast<void *>(3 * sizeof(GLfloat)));
+	glDrawArrays(GL_TRIANGLES, c.first, c.count);
+
+	shader.disable();
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GLBackend::submit(const CommandList& list)
+{
+	stats.commands.fill(0);
+	stats.draws.fill(0);
+
+	static const char *passNames[RP_count] = { "sprites", "text" };
+
+	const Command *group = nullptr;
+
+	for (const auto& c : list) {
+		stats.commands[c.pass]++;
+
+		if (group == nullptr || c.pass != group->pass || c.shader != group->shader) {
+			if (group != nullptr)
+				end(group->pass, *group->shader);
+			if (group == nullptr || c.pass != group->pass)
+				Render::gpuTimer.begin(passNames[c.pass]);
+			begin(c.pass, *c.shader);
+			group = &c;
+		}
+
+		switch (c.type) {
+		case Command::DrawSprite:
+		case Command::DrawText:
+			batch.setColor(c.color[0], c.color[1], c.color[2], c.color[3]);
+			batch.add(c.tex, c.uv0, c.uv1, c.loc, c.size, c.z, c.flip);
+			break;
+		case Command::DrawMesh:
+			// meshes sort before a shader's sprites, so the batch is empty
+			stats.draws[c.pass]++;
+			drawMesh(c);
+			break;
+		case Command::SetUniform:
+		{
+			auto loc = c.shader->uniform[c.uniform];
+			if (c.n == 1)
+				Render::state::uniform1f(loc, c.value[0]);
+			else if (c.n == 2)
+				Render::state::uniform2f(loc, c.value[0], c.value[1]);
+			else if (c.n == 3)
+				Render::state::uniform3f(loc, c.value[0], c.value[1], c.value[2]);
+			else if (c.n == 4)
+				Render::state::uniform4f(loc, c.value[0], c.value[1], c.value[2], c.value[3]);
+			break;
+		}
+		}
+	}
+
+	if (group != nullptr) {
+		end(group->pass, *group->shader);
+		group->shader->unuse();
+		Render::gpuTimer.end();
+	}
+}
+
+void NullBackend::submit(const CommandList& list)
+{
+	stats.commands.fill(0);
+	stats.draws.fill(0);
+
+	for (const auto& c : list)
+		stats.commands[c.pass]++;
+}
+
+/* ----------------------------------------------------------------------------
+** Frames
+** --------------------------------------------------------------------------*/
+
+static std::mutex frameMutex;
+
+// what's been handed over for the next submit
+static CommandList pending;
+
+static std::unique_ptr<Backend> backend (new GLBackend);
+
+CommandList& commands(void)
+{
+	thread_local CommandList list;
+	return list;
+}
+
+void handOverCommands(void)
+{
+	auto& list = commands();
+	if (list.size() == 0)
+		return;
+
+	std::lock_guard<std::mutex> lock (frameMutex);
+	pending.append(list);
+	list.clear();
+}
+
+void submitCommands(void)
+{
+	// kept between frames, so its storage gets reused
+	static CommandList frame;
+
+	handOverCommands();
+
+	{
+		std::lock_guard<std::mutex> lock (frameMutex);
+		frame.swap(pending);
+	}
+
+	frame.sort();
+	backend->submit(frame);
+	frame.clear();
+}
+
+void setBackend(std::unique_ptr<Backend> b)
+{
+	if (b)
+		backend = std::move(b);
+}
+
+Backend& getBackend(void)
+{
+	return *backend;
+}
+
+}
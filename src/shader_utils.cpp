@@ -3,6 +3,7 @@
 using namespace std;
 
 #include <shader_utils.hpp>
+#include <render.hpp>
 //#include <SDL_opengles2.h>
 
 /**
@@ -111,6 +112,7 @@ GLuint create_program(const char *vertexfile, const char *fragmentfile) {
 	if (!link_ok) {
 		SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO, "glLinkProgram:");
 		print_log(program);
+		Render::state::forgetProgram(program);
 		glDeleteProgram(program);
 		return 0;
 	}
@@ -0,0 +1,441 @@
+#include <snapshot.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+#include <unordered_set>
+
+#include <components.hpp>
+#include <dirty.hpp>
+#include <engine.hpp>
+#include <gametime.hpp>
+#include <player.hpp>
+
+/* ----------------------------------------------------------------------------
+** Packing section
+** --------------------------------------------------------------------------*/
+
+template<typename T>
+static void put(std::vector<uint8_t>& out, const T& v)
+{
+	static_assert(std::is_trivially_copyable<T>::value, "can only put plain data");
+
+	auto p = reinterpret_cast<const uint8_t *>(&v);
+	out.insert(out.end(), p, p + sizeof(T));
+}
+
+template<typename T>
+static bool get(const std::vector<uint8_t>& in, size_t& pos, T& v)
+{
+	static_assert(std::is_trivially_copyable<T>::value, "can only get plain data");
+
+	if (pos + sizeof(T) > in.size())
+		return false;
+
+	std::memcpy(&v, in.data() + pos, sizeof(T));
+	pos += sizeof(T);
+	return true;
+}
+
+// components are packed as they are, unless they need special treatment
+template<typename C>
+static void pack(std::vector<uint8_t>& out, const C& c)
+{
+	if (!std::is_empty<C>::value)
+		put(out, c);
+}
+
+template<typename C>
+static bool unpack(const std::vector<uint8_t>& in, size_t& pos, C& c)
+{
+	return std::is_empty<C>::value || get(in, pos, c);
+}
+
+// sprite handles only mean something within one run, so images go by path
+static void pack(std::vector<uint8_t>& out, const Sprite& s)
+{
+	put(out, static_cast<uint8_t>(s.segmentCount));
+	put(out, s.faceLeft);
+
+	for (const auto& seg : s.getSprite()) {
+		auto path = game::sprite_l.getPath(seg.first.id);
+		put(out, static_cast<uint16_t>(path.size()));
+		out.insert(out.end(), path.begin(), path.end());
+		put(out, seg.first.offset);
+		put(out, seg.second);
+	}
+}
+
+static bool unpack(const std::vector<uint8_t>& in, size_t& pos, Sprite& s)
+{
+	uint8_t count;
+	if (!get(in, pos, count) || !get(in, pos, s.faceLeft) || count > SPRITE_SEGMENTS_MAX)
+		return false;
+
+	s.clearSprite();
+	for (unsigned int i = 0; i < count; i++) {
+		uint16_t length;
+		if (!get(in, pos, length) || pos + length > in.size())
+			return false;
+
+		std::string path (in.begin() + pos, in.begin() + pos + length);
+		pos += length;
+
+		SpriteData data;
+		vec2 loc;
+		if (!get(in, pos, data.offset) || !get(in, pos, loc))
+			return false;
+
+		// an image that had no path to save is left out
+		if (path.empty())
+			continue;
+
+		data.id = game::sprite_l.loadSprite(path);
+		s.addSpriteSegment(data, loc);
+	}
+
+	return true;
+}
+
+/**
+ * The components that make it into snapshots; one bit of an entity's mask
+ * each, in this order.
+ */
+template<typename... Cs>
+struct ComponentList {
+	static_assert(sizeof...(Cs) <= 16, "entity masks are two bytes wide");
+
+	static void write(std::vector<uint8_t>& out, entityx::Entity e) {
+		uint16_t mask = 0, bit = 1;
+		int m[] = { 0, (mask |= e.has_component<Cs>() ? bit : 0, bit <<= 1, 0)... };
+		(void)m;
+
+		put(out, mask);
+
+		int w[] = { 0, (e.has_component<Cs>() ? (pack(out, *e.component<Cs>().get()), 0) : 0)... };
+		(void)w;
+	}
+
+	static bool read(const std::vector<uint8_t>& in, size_t& pos, entityx::Entity e) {
+		uint16_t mask, bit = 1;
+		if (!get(in, pos, mask))
+			return false;
+
+		bool ok = true;
+		int r[] = { 0, (ok = ok && readOne<Cs>(in, pos, e, mask & bit), bit <<= 1, 0)... };
+		(void)r;
+		return ok;
+	}
+
+	template<typename C>
+	static bool readOne(const std::vector<uint8_t>& in, size_t& pos, entityx::Entity e, bool present) {
+		if (!present) {
+			if (e.has_component<C>())
+				e.remove<C>();
+			return true;
+		}
+
+		C c;
+		if (!unpack(in, pos, c))
+			return false;
+
+		// overwrite in place where we can, to not stir up component events;
+		// change tracking has to hear about it instead
+		if (e.has_component<C>())
+			game::write<C>(e) = c;
+		else
+			e.assign_from_copy<C>(c);
+		return true;
+	}
+};
+
+using Saved = ComponentList<Position, Direction, Physics, Health, Solid, Sprite, Visible, CameraTarget, Light>;
+
+std::vector<uint8_t> SnapshotSystem::serialize(entityx::EntityManager &en)
+{
+	std::vector<uint8_t> out;
+	uint32_t count = 0;
+
+	// the count is filled in once known
+	put(out, count);
+
+	for (auto e : en.entities_for_debugging()) {
+		put(out, e.id().index());
+		put(out, e.id().version());
+		Saved::write(out, e);
+		count++;
+	}
+
+	std::memcpy(out.data(), &count, sizeof(count));
+	return out;
+}
+
+SnapshotSystem::Remap SnapshotSystem::deserialize(const std::vector<uint8_t>& raw, entityx::EntityManager &en)
+{
+	size_t pos = 0;
+	uint32_t count;
+	Remap remap;
+
+	if (!get(raw, pos, count))
+		return remap;
+
+	std::unordered_set<entityx::Entity::Id> kept;
+
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t index, version;
+		if (!get(raw, pos, index) || !get(raw, pos, version))
+			return remap;
+
+		entityx::Entity::Id id (index, version);
+		auto e = en.valid(id) ? en.get(id) : en.create();
+		kept.insert(e.id());
+		if (e.id() != id)
+			remap.emplace(id, e.id());
+
+		if (!Saved::read(raw, pos, e))
+			return remap;
+	}
+
+	std::vector<entityx::Entity> gone;
+	for (auto e : en.entities_for_debugging()) {
+		if (kept.count(e.id()) == 0)
+			gone.push_back(e);
+	}
+
+	for (auto e : gone)
+		e.destroy();
+
+	return remap;
+}
+
+void SnapshotSystem::remapPlayer(const Remap& remap, entityx::EntityManager &en)
+{
+	auto ps = game::engine.getSystem<PlayerSystem>();
+
+	auto found = remap.find(ps->getPlayerId());
+	if (found != remap.end()) {
+		ps->setPlayer(en.get(found->second));
+		return;
+	}
+
+	if (en.valid(ps->getPlayerId()))
+		return;
+
+	// the player's gone; whoever the camera follows stands in for them
+	for (auto e : en.entities_with_components<CameraTarget>()) {
+		ps->setPlayer(e);
+		break;
+	}
+}
+
+/* ----------------------------------------------------------------------------
+** Encoding section
+** --------------------------------------------------------------------------*/
+
+static void putVarint(std::vector<uint8_t>& out, size_t v)
+{
+	while (v >= 0x80) {
+		out.push_back(static_cast<uint8_t>(v) | 0x80);
+		v >>= 7;
+	}
+
+	out.push_back(static_cast<uint8_t>(v));
+}
+
+static size_t getVarint(const std::vector<uint8_t>& in, size_t& pos)
+{
+	size_t v = 0;
+	for (unsigned int shift = 0; pos < in.size() && shift < 64; shift += 7) {
+		auto b = in[pos++];
+		v |= static_cast<size_t>(b & 0x7F) << shift;
+		if (!(b & 0x80))
+			break;
+	}
+
+	return v;
+}
+
+std::vector<uint8_t> SnapshotSystem::encode(const std::vector<uint8_t>& raw)
+{
+	std::vector<uint8_t> out;
+	putVarint(out, raw.size());
+
+	// alternating runs: how many zeros, then how many literal bytes
+	for (size_t i = 0; i < raw.size();) {
+		size_t zeros = i;
+		while (zeros < raw.size() && raw[zeros] == 0)
+			zeros++;
+
+		// short gaps of zeros aren't worth ending a literal run for
+		size_t lit = zeros;
+		while (lit < raw.size() && (raw[lit] != 0 || (lit + 1 < raw.size() && raw[lit + 1] != 0)))
+			lit++;
+
+		putVarint(out, zeros - i);
+		putVarint(out, lit - zeros);
+		out.insert(out.end(), raw.begin() + zeros, raw.begin() + lit);
+		i = lit;
+	}
+
+	return out;
+}
+
+std::vector<uint8_t> SnapshotSystem::decode(const std::vector<uint8_t>& data)
+{
+	size_t pos = 0;
+	std::vector<uint8_t> raw;
+
+	// anything that doesn't add up to the size it claims is corrupt, and
+	// comes back empty
+	auto size = getVarint(data, pos);
+	if (size > SNAPSHOT_RAW_MAX)
+		return raw;
+
+	raw.reserve(size);
+
+	while (pos < data.size()) {
+		auto zeros = getVarint(data, pos);
+		auto lit = getVarint(data, pos);
+		if (zeros > size - raw.size() || lit > size - raw.size() - zeros || lit > data.size() - pos)
+			return std::vector<uint8_t> ();
+
+		raw.insert(raw.end(), zeros, 0);
+		raw.insert(raw.end(), data.begin() + pos, data.begin() + pos + lit);
+		pos += lit;
+	}
+
+	if (raw.size() != size)
+		raw.clear();
+
+	return raw;
+}
+
+/* ----------------------------------------------------------------------------
+** Ring section
+** --------------------------------------------------------------------------*/
+
+void SnapshotSystem::configure(entityx::EventManager &ev)
+{
+	ev.subscribe<WorldActivateEvent>(*this);
+}
+
+void SnapshotSystem::receive(const WorldActivateEvent &wae)
+{
+	(void)wae;
+
+	// the snapshots we have are of another world's entities
+	std::lock_guard<std::mutex> lock (mtx);
+	ring.clear();
+	bytes = 0;
+	keyframe.clear();
+	sinceKeyframe = SNAPSHOT_KEYFRAME_INTERVAL;
+}
+
+void SnapshotSystem::push(Entry e)
+{
+	bytes += e.data.size();
+	ring.emplace_back(std::move(e));
+
+	// drop the oldest snapshots, along with the deltas that need them; the
+	// unencoded keyframe counts against the budget too
+	while (bytes + keyframe.size() > SNAPSHOT_BUDGET && ring.size() > 1) {
+		do {
+			bytes -= ring.front().data.size();
+			ring.pop_front();
+		} while (!ring.empty() && !ring.front().keyframe);
+	}
+
+	if (ring.empty()) {
+		bytes = 0;
+		keyframe.clear();
+		sinceKeyframe = SNAPSHOT_KEYFRAME_INTERVAL;
+	}
+}
+
+void SnapshotSystem::update(entityx::EntityManager &en, entityx::EventManager &ev, entityx::TimeDelta dt)
+{
+	(void)ev;
+	(void)dt;
+
+	// the engine updates every loop; snapshots are taken once a tick
+	auto tick = game::time::getTickCount();
+	if (tick == lastTick)
+		return;
+	lastTick = tick;
+
+	auto raw = serialize(en);
+
+	std::lock_guard<std::mutex> lock (mtx);
+
+	// a delta against a keyframe of another size would only be partly XORed,
+	// so entities coming or going start a new keyframe
+	if (++sinceKeyframe >= SNAPSHOT_KEYFRAME_INTERVAL || raw.size() != keyframe.size()) {
+		keyframe = raw;
+		sinceKeyframe = 0;
+		push(Entry {true, encode(raw)});
+	} else {
+		for (size_t i = 0; i < raw.size(); i++)
+			raw[i] ^= keyframe[i];
+
+		push(Entry {false, encode(raw)});
+	}
+}
+
+bool SnapshotSystem::restore(unsigned int ticksAgo, entityx::EntityManager &en)
+{
+	std::lock_guard<std::mutex> lock (mtx);
+
+	if (ticksAgo >= ring.size())
+		return false;
+
+	size_t target = ring.size() - 1 - ticksAgo;
+	auto raw = decode(ring[target].data);
+
+	if (!ring[target].keyframe) {
+		size_t key = target;
+		while (!ring[key].keyframe)
+			key--;
+
+		auto base = decode(ring[key].data);
+		for (size_t i = 0; i < std::min(raw.size(), base.size()); i++)
+			raw[i] ^= base[i];
+	}
+
+	remapPlayer(deserialize(raw, en), en);
+
+	// what came after is no longer the past, and ids may have changed
+	while (ring.size() > target + 1) {
+		bytes -= ring.back().data.size();
+		ring.pop_back();
+	}
+
+	sinceKeyframe = SNAPSHOT_KEYFRAME_INTERVAL;
+	return true;
+}
+
+bool SnapshotSystem::save(const std::string& file, entityx::EntityManager &en)
+{
+	auto data = encode(serialize(en));
+
+	std::ofstream out (file, std::ios::out | std::ios::binary);
+	if (!out.good())
+		return false;
+
+	out.write(reinterpret_cast<const char *>(data.data()), data.size());
+	return out.good();
+}
+
+bool SnapshotSystem::load(const std::string& file, entityx::EntityManager &en)
+{
+	std::ifstream in (file, std::ios::in | std::ios::binary);
+	if (!in.good())
+		return false;
+
+	std::vector<uint8_t> data ((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	auto raw = decode(data);
+	if (raw.empty())
+		return false;
+
+	remapPlayer(deserialize(raw, en), en);
+	return true;
+}
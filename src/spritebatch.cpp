@@ -0,0 +1,81 @@
+#include <spritebatch.hpp>
+
+#include <algorithm>
+#include <cstddef>
+
+#include <streambuffer.hpp>
+
+void SpriteBatch::add(GLuint tex, vec2 uv0, vec2 uv1, vec2 loc, vec2 size, float z, bool flip)
+{
+	float u0 = flip ? uv1.x : uv0.x;
+	float u1 = flip ? uv0.x : uv1.x;
+	float v0 = uv0.y, v1 = uv1.y;
+
+	float x1 = loc.x + size.x;
+	float y1 = loc.y + size.y;
+
+	GLubyte r = color[0], g = color[1], b = color[2], a = color[3];
+
+	quads.push_back(Quad {tex, z, {
+		{loc.x, loc.y, z, u0, v0, r, g, b, a},
+		{x1,    loc.y, z, u1, v0, r, g, b, a},
+		{x1,    y1,    z, u1, v1, r, g, b, a},
+
+		{x1,    y1,    z, u1, v1, r, g, b, a},
+		{loc.x, y1,    z, u0, v1, r, g, b, a},
+		{loc.x, loc.y, z, u0, v0, r, g, b, a}
+	}});
+}
+
+void SpriteBatch::flush(Shader& shader)
+{
+	drawCount = 0;
+	spriteCount = quads.size();
+
+	if (quads.empty())
+		return;
+
+	// group by texture; within one, draw from the back forward
+	std::stable_sort(quads.begin(), quads.end(), [](const Quad& a, const Quad& b) {
+		return (a.tex != b.tex) ? a.tex < b.tex : a.z > b.z;
+	});
+
+	// write the vertices straight into the stream buffer
+	auto out = static_cast<Vertex *>(Render::stream.map(quads.size() * sizeof(Quad::verts)));
+	for (const auto& q : quads)
+		out = std::copy(std::begin(q.verts), std::end(q.verts), out);
+	auto base = Render::stream.unmap();
+
+	Render::state::uniform1i(shader.uniform[WU_texture], 0);
+	shader.enable();
+
+	glVertexAttribPointer(shader.coord, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+	                      reinterpret_cast<void *>(base + offsetof(Vertex, x)));
+	glVertexAttribPointer(shader.tex, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+	                      reinterpret_cast<void *>(base + offsetof(Vertex, u)));
+
+	if (shader.color >= 0) {
+		Render::state::enableAttrib(shader.color);
+		glVertexAttribPointer(shader.color, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex),
+		                      reinterpret_cast<void *>(base + offsetof(Vertex, r)));
+	}
+
+	// one draw per run of quads sharing a texture
+	for (size_t i = 0; i < quads.size();) {
+		size_t end = i;
+		while (end < quads.size() && quads[end].tex == quads[i].tex)
+			end++;
+
+		Render::state::bindTexture(quads[i].tex);
+		glDrawArrays(GL_TRIANGLES, i * 6, (end - i) * 6);
+		drawCount++;
+
+		i = end;
+	}
+
+	if (shader.color >= 0)
+		Render::state::disableAttrib(shader.color);
+	shader.disable();
+
+	quads.clear();
+}
@@ -0,0 +1,103 @@
+#include <streambuffer.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+// keeps every write's offset suitably aligned for any vertex format
+constexpr const size_t STREAM_ALIGN = 16;
+
+void *StreamBuffer::map(size_t bytes)
+{
+	if (vbo == 0) {
+		glGenBuffers(1, &vbo);
+		mapRange = GLEW_VERSION_3_0 || GLEW_ARB_map_buffer_range;
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+	// out of room: orphan what's there and start again at the front
+	head = (head + STREAM_ALIGN - 1) & ~(STREAM_ALIGN - 1);
+	if (size == 0 || head + bytes > size) {
+		while (size < std::max(bytes, STREAM_BUFFER_SIZE))
+			size = std::max(size * 2, STREAM_BUFFER_SIZE);
+
+		glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+		head = 0;
+		frame.orphans++;
+	}
+
+	writeOffset = head;
+	writeBytes = bytes;
+	head += bytes;
+
+	frame.writes++;
+	frame.bytes += bytes;
+
+	// nothing's drawn from past the head, so there's no need to wait on the GPU
+	staged = true;
+	if (mapRange && bytes > 0) {
+		auto p = glMapBufferRange(GL_ARRAY_BUFFER, writeOffset, bytes,
+		                          GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		if (p != nullptr) {
+			staged = false;
+			return p;
+		}
+	}
+
+	if (staging.size() < bytes)
+		staging.resize(bytes);
+	return staging.data();
+}
+
+GLintptr StreamBuffer::unmap(void)
+{
+	if (staged)
+		glBufferSubData(GL_ARRAY_BUFFER, writeOffset, writeBytes, staging.data());
+	else
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+
+	return writeOffset;
+}
+
+GLintptr StreamBuffer::push(const void *data, size_t bytes)
+{
+	std::memcpy(map(bytes), data, bytes);
+	return unmap();
+}
+
+void StreamBuffer::endFrame(void)
+{
+	lastFrame = frame;
+	frame = Stats {0, 0, 0};
+}
+
+namespace Render {
+
+StreamBuffer stream;
+
+void streamVertices(Shader& s, GLsizei count, const GLfloat *coords, const GLfloat *tex, GLsizei stride)
+{
+	if (stride != 0) {
+		// one interleaved array; copy it from whichever attribute comes first
+		auto start = std::min(coords, tex);
+		auto offset = stream.push(start, count * stride);
+		glVertexAttribPointer(s.coord, 3, GL_FLOAT, GL_FALSE, stride,
+		                      reinterpret_cast<void *>(offset + (coords - start) * sizeof(GLfloat)));
+		glVertexAttribPointer(s.tex, 2, GL_FLOAT, GL_FALSE, stride,
+		                      reinterpret_cast<void *>(offset + (tex - start) * sizeof(GLfloat)));
+		return;
+	}
+
+	size_t coordBytes = count * 3 * sizeof(GLfloat);
+	size_t texBytes = count * 2 * sizeof(GLfloat);
+
+	auto p = static_cast<unsigned char *>(stream.map(coordBytes + texBytes));
+	std::memcpy(p, coords, coordBytes);
+	std::memcpy(p + coordBytes, tex, texBytes);
+	auto offset = stream.unmap();
+
+	glVertexAttribPointer(s.coord, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void *>(offset));
+	glVertexAttribPointer(s.tex, 2, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void *>(offset + coordBytes));
+}
+
+}
@@ -1,5 +1,7 @@
 #include <algorithm>
+#include <array>
 #include <string>
+#include <unordered_map>
 
 #include <texture.hpp>
 
@@ -41,12 +43,18 @@ uint toOctal(T toConvert)
 
 static std::vector<texture_t> LoadedTexture;
 
+/**
+ * The 1x1 textures made by genColor(), by their packed RGBA.
+ */
+
+static std::unordered_map<uint32_t, GLuint> ColorTexture;
+
 namespace Texture{
 	Color pixels[8][4];
 
 	GLuint loadTexture(std::string fileName) {
 		SDL_Surface *image;
-		static GLuint object = 0;
+		GLuint object;
 
 		// check if texture is already loaded
 		for(auto &t : LoadedTexture) {
@@ -71,8 +79,8 @@ namespace Texture{
 		/*
 		 * Load texture through OpenGL.
 		 */
-		//glGenTextures(1,&object);				// Turns "object" into a texture
-		glBindTexture(GL_TEXTURE_2D,++object);	// Binds "object" to the top of the stack
+		glGenTextures(1,&object);				// Turns "object" into a texture
+		Render::state::bindTexture(object);	// Binds "object" to the top of the stack
 		glPixelStoref(GL_UNPACK_ALIGNMENT,1);
 
 		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);	// Sets the "min" filter
@@ -103,32 +111,25 @@ namespace Texture{
 
     GLuint genColor(Color c)
     {
-        std::string out;
-        
-        // add the red
-        out += static_cast<int>(c.red);
-
-        // add the green
-        out += static_cast<int>(c.green);
+        auto channel = [](float v) {
+            return static_cast<GLubyte>(std::clamp(v, 0.0f, 255.0f) + 0.5f);
+        };
 
-        // add the blue
-        out += static_cast<int>(c.blue);
+        std::array<GLubyte, 4> out {{
+            channel(c.red), channel(c.green), channel(c.blue), channel(c.alpha)
+        }};
 
-        // add the alpha
-        out += static_cast<int>(c.alpha);
+        // each color is made once; solid fills after that cost a lookup
+        uint32_t key = (static_cast<uint32_t>(out[0]) << 24) | (out[1] << 16) | (out[2] << 8) | out[3];
+        auto it = ColorTexture.find(key);
+        if (it != ColorTexture.end())
+            return it->second;
 
         GLuint object;
 
-        glActiveTexture(GL_TEXTURE0);
+        Render::state::activeTexture(GL_TEXTURE0);
         glGenTextures(1,&object);				// Turns "object" into a texture
-		glBindTexture(GL_TEXTURE_2D,object);	// Binds "object" to the top of the stack
-		//glPixelStorei(GL_UNPACK_ALIGNMENT,1);
-
-		//glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);	// Sets the "min" filter
-		//glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);	// The the "max" filter of the stack
-
-		//glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE); // Wrap the texture to the matrix
-		//glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE); //
+		Render::state::bindTexture(object);	// Binds "object" to the top of the stack
 
 		glTexImage2D(GL_TEXTURE_2D,     // Sets the texture to the image file loaded above
 					 0,                 // level
@@ -140,7 +141,8 @@ namespace Texture{
 					 GL_UNSIGNED_BYTE,  // type
 					 out.data()         // source
 					);
-        
+
+        ColorTexture.emplace(key, object);
         return object;
     }
 
@@ -154,9 +156,13 @@ namespace Texture{
 
 	void freeTextures(void) {
 		while(!LoadedTexture.empty()) {
-			glDeleteTextures(1, &LoadedTexture.back().tex);
+			Render::state::deleteTextures(1, &LoadedTexture.back().tex);
 			LoadedTexture.pop_back();
 		}
+
+		for (const auto& c : ColorTexture)
+			Render::state::deleteTextures(1, &c.second);
+		ColorTexture.clear();
 	}
 
 	#define CINDEX_WIDTH (8*4*3)
@@ -169,8 +175,8 @@ namespace Texture{
 		bufferf = new GLfloat[CINDEX_WIDTH];
 
 		colorIndex = loadTexture("assets/colorIndex.png");
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, colorIndex);
+		Render::state::activeTexture(GL_TEXTURE0);
+		Render::state::bindTexture(colorIndex);
 		glGetTexImage(GL_TEXTURE_2D, 0, GL_RGB, GL_UNSIGNED_BYTE, buffer);
 
 		for(i = 0; i < CINDEX_WIDTH; i++)
@@ -257,7 +263,7 @@ Texturec::~Texturec() {
 
 void Texturec::bind(unsigned int bn) {
 	texState = bn;
-	glBindTexture(GL_TEXTURE_2D,image[(int)texState]);
+	Render::state::bindTexture(image[(int)texState]);
 }
 
 void Texturec::bindNext() {
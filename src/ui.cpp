@@ -6,8 +6,15 @@
 #include <gametime.hpp>
 
 #include <render.hpp>
+#include <streambuffer.hpp>
+#include <gputimer.hpp>
 #include <engine.hpp>
 #include <events.hpp>
+#include <profiler.hpp>
+#include <rendercommands.hpp>
+#include <glyphcache.hpp>
+#include <commands.hpp>
+#include <snapshot.hpp>
 
 extern Menu* currentMenu;
 
@@ -37,24 +44,23 @@ SDL_Keycode getControl(unsigned int index)
 static FT_Library   ftl;
 static FT_Face      ftf;
 
-typedef struct {
-	vec2 wh;
-	vec2 bl;
-	vec2 ad;
-} FT_Info;
-
-static std::vector<FT_Info> ftdat16 (93, { { 0, 0 }, { 0, 0 }, { 0, 0 } });
-static std::vector<GLuint>  ftex16  (93, 0);
-static bool ft16loaded = false;
-
-static std::vector<FT_Info> ftdat24 (93, { { 0, 0 }, { 0, 0 }, { 0, 0 } });
-static std::vector<GLuint>  ftex24  (93, 0);
-static bool ft24loaded = false;
+/**
+ * Every glyph drawn so far, at every size it's been drawn at.
+ */
+static GlyphCache glyphs;
 
-static auto *ftdat = &ftdat16;
-static auto *ftex  = &ftex16;
+/**
+ * Outline and shadow applied to all text, off until set.
+ */
+static GLfloat fontOutline[4] = {0, 0, 0, 0};
+static GLfloat fontOutlineWidth = 0;
+static GLfloat fontShadow[4] = {0, 0, 0, 0};
+static vec2    fontShadowOffset;
 
-static unsigned char fontColor[4] = {255,255,255,255};
+/**
+ * The color text is put in.
+ */
+static GLubyte fontColor[4] = {255, 255, 255, 255};
 
 /*
  *	Variables for dialog boxes / options.
@@ -86,61 +92,6 @@ Mix_Chunk *sanic;
 static GLuint pageTex = 0;
 static bool   pageTexReady = false;
 
-void loadFontSize(unsigned int size, std::vector<GLuint> &tex, std::vector<FT_Info> &dat)
-{
-	FT_Set_Pixel_Sizes(ftf,0,size);
-
-	/*
-	 *	Pre-render 'all' the characters.
-	*/
-
-	glDeleteTextures(93, tex.data());
-	glGenTextures(93, tex.data());		//	Generate new texture name/locations?
-
-	for(char i=33;i<126;i++) {
-
-		/*
-		 *	Load the character from the font family file.
-		*/
-
-		if (FT_Load_Char (ftf, i, FT_LOAD_RENDER))
-			UserError("Error! Unsupported character " + i);
-
-		/*
-		 *	Transfer the character's bitmap (?) to a texture for rendering.
-		*/
-
-		glBindTexture(GL_TEXTURE_2D,tex[i-33]);
-		glTexParameterf(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S		,GL_CLAMP_TO_EDGE);
-		glTexParameterf(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T		,GL_CLAMP_TO_EDGE);
-		glTexParameterf(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER	,GL_LINEAR		);
-		glTexParameterf(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER	,GL_LINEAR		);
-		glPixelStorei(GL_UNPACK_ALIGNMENT,1);
-
-		/*
-		 *	The just-created texture will render red-on-black if we don't do anything to it, so
-		 *	here we create a buffer 4 times the size and transform the texture into an RGBA array,
-		 *	making it white-on-black.
-		*/
-
-
-		std::vector<uint32_t> buf (ftf->glyph->bitmap.width * ftf->glyph->bitmap.rows, 0xFFFFFFFF);
-
-		for(unsigned int j = buf.size(); j--;)
-			buf[j] ^= !ftf->glyph->bitmap.buffer[j] ? buf[j] : 0;
-
-		dat[i - 33].wh.x = ftf->glyph->bitmap.width;
-		dat[i - 33].wh.y = ftf->glyph->bitmap.rows;
-		dat[i - 33].bl.x = ftf->glyph->bitmap_left;
-		dat[i - 33].bl.y = ftf->glyph->bitmap_top;
-		dat[i - 33].ad.x = ftf->glyph->advance.x >> 6;
-		dat[i - 33].ad.y = ftf->glyph->advance.y >> 6;
-
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, ftf->glyph->bitmap.width, ftf->glyph->bitmap.rows,
-			          0, GL_RGBA, GL_UNSIGNED_BYTE, buf.data());
-	}
-}
-
 namespace ui {
 
 	bool fadeEnable = false;
@@ -223,14 +174,19 @@ namespace ui {
 	*/
 
 	void setFontFace(const char *ttf) {
+		// the old face's glyphs can't be used again
+		if (ftf != nullptr) {
+			flushText();
+			glyphs.forget(ftf);
+			FT_Done_Face(ftf);
+		}
+
 		if (FT_New_Face(ftl, ttf, 0, &ftf))
 			UserError("Error! Couldn't open " + (std::string)ttf + ".");
 
 #ifdef DEBUG
 		DEBUG_printf("Using font %s\n",ttf);
 #endif // DEBUG
-		ft16loaded = false;
-		ft24loaded = false;
 	}
 
 	/*
@@ -238,23 +194,9 @@ namespace ui {
 	*/
 
 	void setFontSize(unsigned int size) {
-		if (size == 16) {
-			if (!ft16loaded) {
-				loadFontSize(fontSize = size, ftex16, ftdat16);
-				ft16loaded = true;
-			}
-			ftex = &ftex16;
-			ftdat = &ftdat16;
-			fontSize = 16;
-		} else if (size == 24) {
-			if (!ft24loaded) {
-				loadFontSize(fontSize = size, ftex24, ftdat24);
-				ft24loaded = true;
-			}
-			ftex = &ftex24;
-			ftdat = &ftdat24;
-			fontSize = 24;
-		}
+		// glyphs are rendered as they're needed, so any size will do
+		if (size > 0)
+			fontSize = size;
 	}
 
 	/*
@@ -262,96 +204,85 @@ namespace ui {
 	*/
 
 	void setFontColor(unsigned char r,unsigned char g,unsigned char b) {
-		fontColor[0]=r;
-		fontColor[1]=g;
-		fontColor[2]=b;
-		fontColor[3]=255;
+		setFontColor(r, g, b, 255);
 	}
 
 	void setFontColor(unsigned char r,unsigned char g,unsigned char b, unsigned char a) {
-		fontColor[0]=r;
-		fontColor[1]=g;
-		fontColor[2]=b;
-		fontColor[3]=a;
+		fontColor[0] = r, fontColor[1] = g, fontColor[2] = b, fontColor[3] = a;
 	}
 
 	/*
- 	 *	Set the font's z layer
- 	 */
-	void setFontZ(float z) {
-		fontZ = z;
+	 *	Outlines all text; the width is in pixels at 32px text, and at most 4.
+	*/
+
+	void setFontOutline(unsigned char r, unsigned char g, unsigned char b, unsigned char a, float width) {
+		fontOutline[0] = r / 255.0f;
+		fontOutline[1] = g / 255.0f;
+		fontOutline[2] = b / 255.0f;
+		fontOutline[3] = a / 255.0f;
+		fontOutlineWidth = std::min(width, static_cast<float>(GLYPH_SDF_SPREAD)) / (GLYPH_SDF_SPREAD * 2);
 	}
 
 	/*
-	 *	Draws a character at the specified coordinates, aborting if the character is unknown.
+	 *	Shadows all text, offset by pixels at 32px text (each way at most 4).
 	*/
 
-	vec2 putChar(float xx,float yy,char c){
-		vec2 c1,c2;
-
-		int x = xx, y = yy;
-
-		/*
-		 *	Get the width and height of the rendered character.
-		*/
-
-		c1={(float)floor(x)+(*ftdat)[c-33].bl.x,
-		    (float)floor(y)+(*ftdat)[c-33].bl.y};
-		c2=(*ftdat)[c-33].wh;
-
-		/*
-		 *	Draw the character:
-		*/
-
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D,(*ftex)[c-33]);
-		glUniform1i(Render::textShader.uniform[WU_texture], 0);
+	void setFontShadow(unsigned char r, unsigned char g, unsigned char b, unsigned char a, vec2 offset) {
+		fontShadow[0] = r / 255.0f;
+		fontShadow[1] = g / 255.0f;
+		fontShadow[2] = b / 255.0f;
+		fontShadow[3] = a / 255.0f;
 
-		//glDisable(GL_DEPTH_TEST);
+		// any further and the shadow would sample past the glyph's padding
+		const float spread = GLYPH_SDF_SPREAD;
+		offset.x = std::clamp(offset.x, -spread, spread);
+		offset.y = std::clamp(offset.y, -spread, spread);
 
-		Render::textShader.use();
-		Render::textShader.enable();
+		// texture coordinates run down the page, the screen runs up
+		fontShadowOffset.x = offset.x / GLYPH_PAGE_SIZE;
+		fontShadowOffset.y = -offset.y / GLYPH_PAGE_SIZE;
+	}
 
-		GLfloat tex_coord[] = {
-			0.0, 1.0,				//bottom left
-			1.0, 1.0,				//bottom right
-			1.0, 0.0,				//top right
+	/*
+ 	 *	Set the font's z layer
+ 	 */
+	void setFontZ(float z) {
+		fontZ = z;
+	}
 
-			1.0, 0.0,				//top right
-			0.0, 0.0,				//top left
-			0.0, 1.0,				//bottom left
+	/*
+	 *	Records a character at the specified coordinates, to be drawn by flushText().
+	*/
 
-		};
+	vec2 putChar(float xx,float yy,char32_t c){
+		auto glyph = glyphs.get(ftf, fontSize, c);
 
-		GLfloat text_vert[] = {
-			c1.x, 		c1.y     -c2.y, fontZ,	//bottom left
-			c1.x+c2.x, 	c1.y	 -c2.y, fontZ, 	//bottom right
-			c1.x+c2.x, 	c1.y+c2.y-c2.y, fontZ,	//top right
+		int x = xx, y = yy;
 
-			c1.x+c2.x, 	c1.y+c2.y-c2.y, fontZ,	//top right
-			c1.x, 		c1.y+c2.y-c2.y, fontZ,	//top left
-			c1.x, 		c1.y	 -c2.y, fontZ	//bottom left
-		};
+		// the glyph hangs off its baseline by its height, less the bearing
+		vec2 loc ((float)floor(x) + glyph.bl.x,
+		          (float)floor(y) + glyph.bl.y - glyph.wh.y);
 
-        glUniform4f(Render::textShader.uniform[WU_tex_color],
-                    static_cast<float>(fontColor[0]/255),
-                    static_cast<float>(fontColor[1]/255),
-                    static_cast<float>(fontColor[2]/255),
-                    static_cast<float>(fontColor[3]/255));
+		if (glyph.tex != 0 && Render::cull::test(CK_text, Render::getView(), loc, glyph.wh))
+			Render::commands().drawText(RP_text, Render::fontShader, glyph.tex, glyph.uv0, glyph.uv1, loc, glyph.wh, fontZ, fontColor);
 
-		glVertexAttribPointer(Render::textShader.coord, 3, GL_FLOAT, GL_FALSE, 0, text_vert);
-		glVertexAttribPointer(Render::textShader.tex,  	2, GL_FLOAT, GL_FALSE, 0, tex_coord);
-		glDrawArrays(GL_TRIANGLES, 0, 6);
+		// return the width.
+		return glyph.ad;
+	}
 
-        glUniform4f(Render::textShader.uniform[WU_tex_color], 1.0, 1.0, 1.0, 1.0);
+	void flushText(void) {
+		auto& commands = Render::commands();
+		GLfloat shadowOffset[2] = {fontShadowOffset.x, fontShadowOffset.y};
 
-		Render::textShader.disable();
-		Render::textShader.unuse();
+		commands.setUniform(RP_text, Render::fontShader, FU_outline_color, fontOutline, 4);
+		commands.setUniform(RP_text, Render::fontShader, FU_outline_width, &fontOutlineWidth, 1);
+		commands.setUniform(RP_text, Render::fontShader, FU_shadow_color, fontShadow, 4);
+		commands.setUniform(RP_text, Render::fontShader, FU_shadow_offset, shadowOffset, 2);
 
-		//glEnable(GL_DEPTH_TEST);
+		// the glyphs recorded this frame must be drawn before their pages can change
+		Render::submitCommands();
 
-		// return the width.
-		return (*ftdat)[c-33].ad;
+		glyphs.nextFrame();
 	}
 
 	/*
@@ -359,14 +290,15 @@ namespace ui {
 	*/
 
 	float putString(const float x, const float y, std::string s) {
-		unsigned int i = 0, nl = 1;
+		size_t i = 0;
+		unsigned int nl = 1;
 		vec2 add, o = {x, y};
 
 		/*
 		 * Loop on each character:
 		 */
 
-		do {
+		while (i < s.size()) {
 			if (dialogBoxExists && o.x > textWrapLimit * nl + x) {
 
  				o.y -= fontSize * 1.05f;
@@ -378,7 +310,11 @@ namespace ui {
   					i++;
   			}
 
-			switch (s[i]) {
+			auto c = game::nextCodepoint(s, i);
+
+			switch (c) {
+			case 0:
+				break;
 			case '\n':
 				o.y -= fontSize * 1.05f;
 				o.x = x;
@@ -394,22 +330,26 @@ namespace ui {
 				o.x += fontSize / 2;
 				break;
 			default:
-				add = putChar(floor(o.x), floor(o.y), s[i]);
+				add = putChar(floor(o.x), floor(o.y), c);
 				o.x += add.x;
 				o.y += add.y;
 				break;
 			}
-		} while (s[++i]);
+		}
 
 		return o.x;	// i.e. the string width
 	}
 
 	float putStringCentered(const float x, const float y, std::string s) {
-		unsigned int i = 0;
+		size_t i = 0;
 		float width = 0;
 
-		do {
-			switch (s[i]) {
+		while (i < s.size()) {
+			auto c = game::nextCodepoint(s, i);
+
+			switch (c) {
+			case 0:
+				break;
 			case '\n':
 				// TODO
 				break;
@@ -419,10 +359,10 @@ namespace ui {
 				width += fontSize / 2;
 				break;
 			default:
-				width += (*ftdat)[i].wh.x + fontSize * 0.1f;
+				width += glyphs.get(ftf, fontSize, c).ad.x;
 				break;
 			}
-		} while(s[++i]);
+		}
 		putString(floor(x-width/2),y,s);
 		return width;
 	}
@@ -653,23 +593,21 @@ namespace ui {
         static GLuint boxT = Texture::genColor(Color(0,0,0));
         static GLuint lineT = Texture::genColor(Color(255,255,255));
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, boxT);
-        glUniform1i(Render::textShader.uniform[WU_texture], 0);
+        Render::state::activeTexture(GL_TEXTURE0);
+        Render::state::bindTexture(boxT);
+        Render::state::uniform1i(Render::textShader.uniform[WU_texture], 0);
 
         Render::textShader.use();
 		Render::textShader.enable();
 
-        glVertexAttribPointer(Render::textShader.coord, 3, GL_FLOAT, GL_FALSE, 0, box);
-        glVertexAttribPointer(Render::textShader.tex, 2, GL_FLOAT, GL_FALSE, 0, box_tex);
-        glDrawArrays(GL_TRIANGLES, 0 ,6);
+        Render::streamVertices(Render::textShader, 6, box, box_tex);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
 
-        glBindTexture(GL_TEXTURE_2D, lineT);
-        glUniform1i(Render::textShader.uniform[WU_texture], 0);
+        Render::state::bindTexture(lineT);
+        Render::state::uniform1i(Render::textShader.uniform[WU_texture], 0);
 
-        glVertexAttribPointer(Render::textShader.coord, 3, GL_FLOAT, GL_FALSE, 0, line_strip);
-        glVertexAttribPointer(Render::textShader.tex, 2, GL_FLOAT, GL_FALSE, 0, box_tex);
-        glDrawArrays(GL_LINE_STRIP, 0 ,8);
+        Render::streamVertices(Render::textShader, 5, line_strip, box_tex);
+        glDrawArrays(GL_LINE_STRIP, 0, 5);
 
         Render::textShader.disable();
 		Render::textShader.unuse();
@@ -769,60 +707,51 @@ namespace ui {
 							c1.x + box_corner_dim.x,	c2.y - box_corner_dim.y, z, 0.5f, 0.5f,
 							c1.x + box_corner_dim.x,	c1.y + box_corner_dim.y, z, 0.5f, 0.5f};
 
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, box_corner);
-		glUniform1f(Render::textShader.uniform[WU_texture], 0);
+		Render::state::activeTexture(GL_TEXTURE0);
+		Render::state::bindTexture(box_corner);
+		Render::state::uniform1f(Render::textShader.uniform[WU_texture], 0);
 
 		Render::textShader.use();
 		Render::textShader.enable();
 
 		// draw upper left corner
-        glVertexAttribPointer(Render::textShader.coord, 3, GL_FLOAT, GL_FALSE, stride, &box_ul[0]);
-        glVertexAttribPointer(Render::textShader.tex,   2, GL_FLOAT, GL_FALSE, stride, &box_ul[3]);
+        Render::streamVertices(Render::textShader, 6, &box_ul[0], &box_ul[3], stride);
         glDrawArrays(GL_TRIANGLES, 0, 6);
 
 		// lower left corner
-        glVertexAttribPointer(Render::textShader.coord, 3, GL_FLOAT, GL_FALSE, stride, &box_ll[0]);
-        glVertexAttribPointer(Render::textShader.tex,   2, GL_FLOAT, GL_FALSE, stride, &box_ll[3]);
+        Render::streamVertices(Render::textShader, 6, &box_ll[0], &box_ll[3], stride);
         glDrawArrays(GL_TRIANGLES, 0, 6);
 
 		// upper right corner
-		glVertexAttribPointer(Render::textShader.coord, 3, GL_FLOAT, GL_FALSE, stride, &box_ur[0]);
-        glVertexAttribPointer(Render::textShader.tex,   2, GL_FLOAT, GL_FALSE, stride, &box_ur[3]);
+		Render::streamVertices(Render::textShader, 6, &box_ur[0], &box_ur[3], stride);
         glDrawArrays(GL_TRIANGLES, 0, 6);
 
 		// lower right corner
-		glVertexAttribPointer(Render::textShader.coord, 3, GL_FLOAT, GL_FALSE, stride, &box_lr[0]);
-        glVertexAttribPointer(Render::textShader.tex,   2, GL_FLOAT, GL_FALSE, stride, &box_lr[3]);
+		Render::streamVertices(Render::textShader, 6, &box_lr[0], &box_lr[3], stride);
         glDrawArrays(GL_TRIANGLES, 0, 6);
 
 		// draw the middle of the box
-		glVertexAttribPointer(Render::textShader.coord, 3, GL_FLOAT, GL_FALSE, stride, &box_f[0]);
-        glVertexAttribPointer(Render::textShader.tex,   2, GL_FLOAT, GL_FALSE, stride, &box_f[3]);
+		Render::streamVertices(Render::textShader, 6, &box_f[0], &box_f[3], stride);
         glDrawArrays(GL_TRIANGLES, 0, 6);
 
-		glBindTexture(GL_TEXTURE_2D, box_side);
+		Render::state::bindTexture(box_side);
 
 		// draw the left edge of the box
-		glVertexAttribPointer(Render::textShader.coord, 3, GL_FLOAT, GL_FALSE, stride, &box_l[0]);
-        glVertexAttribPointer(Render::textShader.tex,   2, GL_FLOAT, GL_FALSE, stride, &box_l[3]);
+		Render::streamVertices(Render::textShader, 6, &box_l[0], &box_l[3], stride);
         glDrawArrays(GL_TRIANGLES, 0, 6);
 
 		// draw right edge of the box
-		glVertexAttribPointer(Render::textShader.coord, 3, GL_FLOAT, GL_FALSE, stride, &box_r[0]);
-        glVertexAttribPointer(Render::textShader.tex,   2, GL_FLOAT, GL_FALSE, stride, &box_r[3]);
+		Render::streamVertices(Render::textShader, 6, &box_r[0], &box_r[3], stride);
         glDrawArrays(GL_TRIANGLES, 0, 6);
 
-		glBindTexture(GL_TEXTURE_2D, box_side_top);
+		Render::state::bindTexture(box_side_top);
 
 		// draw bottom of the box
-		glVertexAttribPointer(Render::textShader.coord, 3, GL_FLOAT, GL_FALSE, stride, &box_b[0]);
-        glVertexAttribPointer(Render::textShader.tex,   2, GL_FLOAT, GL_FALSE, stride, &box_b[3]);
+		Render::streamVertices(Render::textShader, 6, &box_b[0], &box_b[3], stride);
         glDrawArrays(GL_TRIANGLES, 0, 6);
 
 		// draw top of the box
-		glVertexAttribPointer(Render::textShader.coord, 3, GL_FLOAT, GL_FALSE, stride, &box_t[0]);
-        glVertexAttribPointer(Render::textShader.tex,   2, GL_FLOAT, GL_FALSE, stride, &box_t[3]);
+		Render::streamVertices(Render::textShader, 6, &box_t[0], &box_t[3], stride);
         glDrawArrays(GL_TRIANGLES, 0, 6);
 
         Render::textShader.disable();
@@ -861,16 +790,15 @@ namespace ui {
                                   0.0, 1.0,
                                   0.0, 0.0};
 
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, pageTex);
-            glUniform1i(Render::textShader.uniform[WU_texture], 0);
+            Render::state::activeTexture(GL_TEXTURE0);
+            Render::state::bindTexture(pageTex);
+            Render::state::uniform1i(Render::textShader.uniform[WU_texture], 0);
 
 			Render::textShader.use();
 			Render::textShader.enable();
 
-            glVertexAttribPointer(Render::textShader.coord, 3, GL_FLOAT, GL_FALSE, 0, page_loc);
-            glVertexAttribPointer(Render::textShader.tex, 2, GL_FLOAT, GL_FALSE, 0, page_tex);
-            glDrawArrays(GL_TRIANGLES, 0 ,6);
+            Render::streamVertices(Render::textShader, 6, page_loc, page_tex);
+            glDrawArrays(GL_TRIANGLES, 0, 6);
 
             Render::textShader.disable();
 			Render::textShader.unuse();
@@ -963,21 +891,19 @@ namespace ui {
                                    hub.x + 150, hub.y + 12, -7.1};
 
 
-                glUniform1i(Render::textShader.uniform[WU_texture], 0);
+                Render::state::uniform1i(Render::textShader.uniform[WU_texture], 0);
 
 				Render::textShader.use();
 				Render::textShader.enable();
 
-                glBindTexture(GL_TEXTURE_2D, frontHealth);
+                Render::state::bindTexture(frontHealth);
 
-                glVertexAttribPointer(Render::textShader.coord, 3, GL_FLOAT, GL_FALSE, 0, front);
-                glVertexAttribPointer(Render::textShader.tex, 2, GL_FLOAT, GL_FALSE, 0, tex);
+                Render::streamVertices(Render::textShader, 4, front, tex);
                 glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-                glBindTexture(GL_TEXTURE_2D, backHealth);
+                Render::state::bindTexture(backHealth);
 
-                glVertexAttribPointer(Render::textShader.coord, 3, GL_FLOAT, GL_FALSE, 0, back);
-                glVertexAttribPointer(Render::textShader.tex, 2, GL_FLOAT, GL_FALSE, 0, tex);
+                Render::streamVertices(Render::textShader, 4, back, tex);
                 glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
                 Render::textShader.disable();
@@ -1034,7 +960,7 @@ namespace ui {
 		dialogPassiveTime = 0;
 
 		if (pageTex) {
-			glDeleteTextures(1, &pageTex);
+			Render::state::deleteTextures(1, &pageTex);
 			pageTex = 0;
 			pageTexReady = false;
 			return;
@@ -1076,10 +1002,11 @@ EXIT:
 			return;
 		}
 
-		if (fadeWhite)
-			glBindTexture(GL_TEXTURE_2D, Texture::genColor(Color(255, 255, 255, fadeIntensity)));
-		else
-			glBindTexture(GL_TEXTURE_2D, Texture::genColor(Color(0, 0, 0, fadeIntensity)));
+		GPU_PASS("fade");
+
+		// one white texture, tinted to the fade's color and intensity
+		static const GLuint white = Texture::genColor(Color(255, 255, 255));
+		Render::state::bindTexture(white);
 
         GLfloat tex[] = {0.0, 0.0,
                         1.0, 0.0,
@@ -1092,15 +1019,19 @@ EXIT:
                               offset.x + SCREEN_WIDTH / 2, offset.y + SCREEN_HEIGHT / 2, 	 -7.9};
 
 		setFontZ(-8.2);
-        glUniform1i(Render::textShader.uniform[WU_texture], 0);
+        Render::state::uniform1i(Render::textShader.uniform[WU_texture], 0);
 
 		Render::textShader.use();
 		Render::textShader.enable();
 
-        glVertexAttribPointer(Render::textShader.coord, 3, GL_FLOAT, GL_FALSE, 0, backdrop);
-        glVertexAttribPointer(Render::textShader.tex, 2, GL_FLOAT, GL_FALSE, 0, tex);
+		float shade = fadeWhite ? 1.0f : 0.0f;
+		Render::state::uniform4f(Render::textShader.uniform[WU_tex_color], shade, shade, shade, fadeIntensity / 255.0f);
+
+        Render::streamVertices(Render::textShader, 4, backdrop, tex);
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
+		Render::state::uniform4f(Render::textShader.uniform[WU_tex_color], 1.0f, 1.0f, 1.0f, 1.0f);
+
 		Render::textShader.disable();
 		Render::textShader.unuse();
 
@@ -1307,6 +1238,42 @@ void InputSystem::update(entityx::EntityManager &en, entityx::EventManager &ev,
 			} else switch (SDL_KEY) {
 			case SDLK_F3:
 				debug ^= true;
+				break;
+			case SDLK_F4:
+				if (debug && game::profiler::dump("profile.txt"))
+					std::cout << "Wrote profile.txt" << std::endl;
+
+				break;
+			// quick-save, rewind and quick-load touch the entities, so they
+			// wait for the update thread
+			case SDLK_F5:
+				if (debug) {
+					game::commands().run([](entityx::EntityManager &en) {
+						(void)en;
+						if (game::engine.getSystem<WorldSystem>()->save(""))
+							std::cout << "Saved snapshot" << std::endl;
+					});
+				}
+
+				break;
+			case SDLK_F7:
+				if (debug) {
+					game::commands().run([](entityx::EntityManager &en) {
+						if (!game::engine.getSystem<SnapshotSystem>()->restore(SNAPSHOT_REWIND_TICKS, en))
+							std::cout << "Can't rewind that far" << std::endl;
+					});
+				}
+
+				break;
+			case SDLK_F9:
+				if (debug) {
+					game::commands().run([](entityx::EntityManager &en) {
+						(void)en;
+						if (game::engine.getSystem<WorldSystem>()->restore(""))
+							std::cout << "Loaded snapshot" << std::endl;
+					});
+				}
+
 				break;
 			case SDLK_BACKSLASH:
 				dialogBoxExists = false;
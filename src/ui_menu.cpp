@@ -1,7 +1,9 @@
 #include <ui_menu.hpp>
 
 #include <engine.hpp>
+#include <gputimer.hpp>
 #include <render.hpp>
+#include <streambuffer.hpp>
 #include <texture.hpp>
 
 #include <fstream>
@@ -198,6 +200,8 @@ namespace ui {
 			auto SCREEN_WIDTH = game::SCREEN_WIDTH;
 			auto SCREEN_HEIGHT = game::SCREEN_HEIGHT;
 
+			GPU_PASS("menu");
+
             SDL_Event e;
 
 			Render::useShader(&Render::textShader);
@@ -244,7 +248,7 @@ namespace ui {
             glColor4f(0.0f, 0.0f, 0.0f, .8f);
 			Render::textShader.use();
 
-			glBindTexture(GL_TEXTURE_2D, backTex);
+			Render::state::bindTexture(backTex);
 			Render::drawRect(vec2(offset.x - SCREEN_WIDTH / 2 - 1, offset.y - (SCREEN_HEIGHT / 2)),
 			                 vec2(offset.x + SCREEN_WIDTH / 2, offset.y + (SCREEN_HEIGHT / 2)), -8.5);
 
@@ -259,7 +263,7 @@ namespace ui {
                     GLuint bsTex = Texture::genColor(Color(m.button.color.red,m.button.color.green,m.button.color.blue));
 
 					Render::textShader.use();
-					glBindTexture(GL_TEXTURE_2D, bsTex);
+					Render::state::bindTexture(bsTex);
 
 					Render::drawRect(vec2(offset.x + m.button.loc.x, offset.y + m.button.loc.y),
 							         vec2(offset.x + m.button.loc.x + m.button.dim.x, offset.y + m.button.loc.y + m.button.dim.y), -8.6);
@@ -273,7 +277,7 @@ namespace ui {
                         if (mouse.y >= offset.y+m.button.loc.y && mouse.y <= offset.y+m.button.loc.y + m.button.dim.y) {
 
                             //if the mouse if over the button, it draws this white outline
-							glBindTexture(GL_TEXTURE_2D, border);
+							Render::state::bindTexture(border);
 
 							GLfloat verts[] = {offset.x+m.button.loc.x, 					offset.y+m.button.loc.y,				-8.7,
                                 			   offset.x+m.button.loc.x+m.button.dim.x, 		offset.y+m.button.loc.y,				-8.7,
@@ -284,8 +288,7 @@ namespace ui {
 							Render::textShader.use();
 							Render::textShader.enable();
 
-							glVertexAttribPointer(Render::textShader.coord, 3, GL_FLOAT, GL_FALSE, 0, verts);
-							glVertexAttribPointer(Render::textShader.tex, 2, GL_FLOAT, GL_FALSE, 0, line_tex);
+							Render::streamVertices(Render::textShader, 5, verts, line_tex);
 							glDrawArrays(GL_LINE_STRIP, 0, 5);
 
 							Render::textShader.disable();
@@ -334,12 +337,12 @@ namespace ui {
                     GLuint bsTex = Texture::genColor(Color(m.slider.color.red, m.slider.color.green, m.slider.color.blue, 175));
 					GLuint hTex =  Texture::genColor(Color(m.slider.color.red, m.slider.color.green, m.slider.color.blue, 255));
 
-					glBindTexture(GL_TEXTURE_2D, bsTex);
+					Render::state::bindTexture(bsTex);
 					Render::drawRect(vec2(offset.x + m.slider.loc.x, offset.y + m.slider.loc.y),
 							         vec2(offset.x + m.slider.loc.x + m.slider.dim.x, offset.y + m.slider.loc.y + m.slider.dim.y), -8.6);
 
 					//draw the slider handle
-                    glBindTexture(GL_TEXTURE_2D, hTex);
+                    Render::state::bindTexture(hTex);
 					if (m.slider.dim.y > m.slider.dim.x) {
                         Render::drawRect(vec2(offset.x+m.slider.loc.x, offset.y+m.slider.loc.y + (m.slider.sliderLoc * 1.05)),
                             	         vec2(offset.x+m.slider.loc.x + sliderW, offset.y+m.slider.loc.y + (m.slider.sliderLoc * 1.05) + sliderH), -8.7);
@@ -358,7 +361,7 @@ namespace ui {
                         if (mouse.y >= offset.y+m.slider.loc.y && mouse.y <= offset.y+m.slider.loc.y + m.slider.dim.y) {
 
                             //if it is we draw a white border around it
-                            glBindTexture(GL_TEXTURE_2D, border);
+                            Render::state::bindTexture(border);
 
 							Render::textShader.use();
 							Render::textShader.enable();
@@ -369,8 +372,7 @@ namespace ui {
                                 					offset.x+m.slider.loc.x, 					offset.y+m.slider.loc.y+m.slider.dim.y,	-8.8,
                                 					offset.x+m.slider.loc.x, 					offset.y+m.slider.loc.y,				-8.8};
 
-							glVertexAttribPointer(Render::textShader.coord, 3, GL_FLOAT, GL_FALSE, 0, box_border);
-							glVertexAttribPointer(Render::textShader.tex, 2, GL_FLOAT, GL_FALSE, 0, line_tex);
+							Render::streamVertices(Render::textShader, 5, box_border, line_tex);
 							glDrawArrays(GL_LINE_STRIP, 0, 5);
                             if (m.slider.dim.y > m.slider.dim.x) {
                                 //and a border around the slider handle
@@ -379,8 +381,7 @@ namespace ui {
                                 						   offset.x+m.slider.loc.x + sliderW, static_cast<GLfloat>(offset.y+m.slider.loc.y + (m.slider.sliderLoc * 1.05) + sliderH),	-8.8,
                                 						   offset.x+m.slider.loc.x,           static_cast<GLfloat>(offset.y+m.slider.loc.y + (m.slider.sliderLoc * 1.05) + sliderH),	-8.8,
                                 						   offset.x+m.slider.loc.x,           static_cast<GLfloat>(offset.y+m.slider.loc.y + (m.slider.sliderLoc * 1.05)),				-8.8};
-								glVertexAttribPointer(Render::textShader.coord, 3, GL_FLOAT, GL_FALSE, 0, handle_border);
-								glVertexAttribPointer(Render::textShader.tex, 2, GL_FLOAT, GL_FALSE, 0, line_tex);
+								Render::streamVertices(Render::textShader, 5, handle_border, line_tex);
 								glDrawArrays(GL_LINE_STRIP, 0, 5);
                             }else{
                                 //and a border around the slider handle
@@ -389,8 +390,7 @@ namespace ui {
                                 						   offset.x+m.slider.loc.x + (m.slider.sliderLoc + sliderW), offset.y+m.slider.loc.y+m.slider.dim.y,-8.8,
                                 						   offset.x+m.slider.loc.x + m.slider.sliderLoc, offset.y+m.slider.loc.y+m.slider.dim.y,			-8.8,
                                 						   offset.x+m.slider.loc.x + m.slider.sliderLoc, offset.y+m.slider.loc.y,							-8.8};
-								glVertexAttribPointer(Render::textShader.coord, 3, GL_FLOAT, GL_FALSE, 0, handle_border);
-								glVertexAttribPointer(Render::textShader.tex, 2, GL_FLOAT, GL_FALSE, 0, line_tex);
+								Render::streamVertices(Render::textShader, 5, handle_border, line_tex);
 								glDrawArrays(GL_LINE_STRIP, 0, 5);
                             }
 
@@ -403,14 +403,14 @@ namespace ui {
                                 if (m.slider.dim.y > m.slider.dim.x) {
                                     *m.slider.var = (((mouse.y-offset.y) - m.slider.loc.y)/m.slider.dim.y)*100;
                                     //draw a white box over the handle
-                                    glBindTexture(GL_TEXTURE_2D, border);
+                                    Render::state::bindTexture(border);
 									Render::drawRect(vec2(offset.x+m.slider.loc.x, offset.y+m.slider.loc.y + (m.slider.sliderLoc * 1.05)),
                                                      vec2(offset.x+m.slider.loc.x + sliderW, offset.y+m.slider.loc.y + (m.slider.sliderLoc * 1.05) + sliderH), -8.9);
 
                                 }else{
                                     *m.slider.var = (((mouse.x-offset.x) - m.slider.loc.x)/m.slider.dim.x)*100;
                                     //draw a white box over the handle
-                                    glBindTexture(GL_TEXTURE_2D, border);
+                                    Render::state::bindTexture(border);
 									Render::drawRect(vec2(offset.x+m.slider.loc.x + m.slider.sliderLoc, offset.y+m.slider.loc.y),
                                                      vec2(offset.x+m.slider.loc.x + (m.slider.sliderLoc + sliderW), offset.y+m.slider.loc.y + m.slider.dim.y), -8.9);
                                 }
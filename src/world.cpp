@@ -16,9 +16,17 @@
 #include <gametime.hpp>
 
 #include <render.hpp>
+#include <streambuffer.hpp>
+#include <gputimer.hpp>
 #include <engine.hpp>
 #include <components.hpp>
 #include <player.hpp>
+#include <dirty.hpp>
+#include <activity.hpp>
+#include <entities.hpp>
+#include <snapshot.hpp>
+#include <pools.hpp>
+#include <rendercommands.hpp>
 
 // local library headers
 #include <tinyxml2.h>
@@ -28,8 +36,8 @@ void makeWorldDrawingSimplerEvenThoughAndyDoesntThinkWeCanMakeItIntoFunctions(
 		unsigned size, void *coordAddr, void *texAddr, unsigned triCount
 	)
 {
-	glVertexAttribPointer(Render::worldShader.coord, 3, GL_FLOAT, GL_FALSE, size, coordAddr);
-	glVertexAttribPointer(Render::worldShader.tex  , 2, GL_FLOAT, GL_FALSE, size, texAddr  );
+	Render::streamVertices(Render::worldShader, triCount, static_cast<GLfloat *>(coordAddr),
+	                       static_cast<GLfloat *>(texAddr), size);
 	glDrawArrays(GL_TRIANGLES, 0, triCount);
 }
 
@@ -65,6 +73,23 @@ constexpr const float GROUND_HILLINESS      =  10.0f;
 // defines grass height in HLINEs
 constexpr const unsigned int GRASS_HEIGHT = 4;
 
+// how many columns of ground are built and drawn as one
+constexpr const unsigned int TERRAIN_CHUNK_COLUMNS = 64;
+
+// each column of ground is two triangles of x, y, z, s, t
+constexpr const unsigned int DIRT_COLUMN_FLOATS = 6 * 5;
+
+// each column of grass is two blades, each two triangles of x, y, z, s, t,
+// then the column and which blade's top the vertex is (0 for the bottom)
+constexpr const unsigned int GRASS_VERTEX_FLOATS = 7;
+constexpr const unsigned int GRASS_COLUMN_FLOATS = 12 * GRASS_VERTEX_FLOATS;
+
+// grass state is kept in a texture this many columns wide
+constexpr const unsigned int GRASS_TEXTURE_WIDTH = 256;
+
+// blade heights are stored in sixteenths
+constexpr const float GRASS_HEIGHT_SCALE = 16.0f;
+
 // the path of the currently loaded XML file, externally referenced in places
 std::string currentXML;
 
@@ -112,7 +137,7 @@ XMLDocument currentXMLDoc;
 ** Functions section
 ** --------------------------------------------------------------------------*/
 
-void WorldSystem::generate(unsigned int width)
+void WorldSystem::generate(WorldData2& world, unsigned int width)
 {
     float geninc = 0;
 
@@ -156,12 +181,14 @@ static Color ambient;
 
 bool WorldSystem::save(const std::string& s)
 {
-	(void)s;
-	/*for (const auto &e : entity)
-		e->saveToXML();
+	auto file = xmlFolder + (s.empty() ? world.xmlFile : s) + ".snap";
+	return SnapshotSystem::save(file, world.entities->entities);
+}
 
-	currentXMLDoc.SaveFile((s.empty() ? currentXML : xmlFolder + s).c_str(), false);*/
-	return false;
+bool WorldSystem::restore(const std::string& s)
+{
+	auto file = xmlFolder + (s.empty() ? world.xmlFile : s) + ".snap";
+	return SnapshotSystem::load(file, world.entities->entities);
 }
 
 /*static bool loadedLeft = false;
@@ -203,7 +230,7 @@ loadWorldFromXMLNoTakeover(std::string path)
 }
 */
 
-void WorldSystem::load(const std::string& file)
+WorldData2 WorldSystem::build(const std::string& file)
 {
 	auto str2coord = [](std::string s) -> vec2 {
 		auto cpos = s.find(',');
@@ -211,14 +238,15 @@ void WorldSystem::load(const std::string& file)
 		return vec2 (std::stof(s), std::stof(s.substr(cpos + 1)));
 	};
 
+	WorldData2 world;
+	XMLDocument xmlDoc;
 	entityx::Entity entity;
 
 	std::string xmlRaw;
 	std::string xmlPath;
 
-	// check for empty file name
-	if (file.empty())
-		return;
+	world.xmlFile = file;
+	world.entities = std::make_shared<WorldEntities>();
 
 	// load file data to string
 	xmlPath = xmlFolder + file;
@@ -258,11 +286,6 @@ void WorldSystem::load(const std::string& file)
 		}
 	}
 
-	world.toLeft = world.toRight = "";
-	currentXMLFile = file;
-
-	
-
 	// iterate through tags
 	while (wxml) {
 		std::string tagName = wxml->Name();
@@ -278,19 +301,17 @@ void WorldSystem::load(const std::string& file)
 			world.style = static_cast<WorldBGType>(styleNo);
 			world.bgm = wxml->StrAttribute("bgm");
 
-			bgFiles.clear();
+			world.sTexLoc.clear();
 
 			const auto& files = bgPaths[(int)world.style];
 
 			for (const auto& f : files)
-				bgFiles.push_back(world.styleFolder + "bg/" + f);
-
-			bgTex = TextureIterator(bgFiles);
+				world.sTexLoc.push_back(world.styleFolder + "bg/" + f);
 		}
 
         // world generation
         else if (tagName == "generation") {
-			generate(wxml->UnsignedAttribute("width") / game::HLINE);
+			generate(world, wxml->UnsignedAttribute("width") / game::HLINE);
 		}
 
 		// indoor stuff
@@ -299,12 +320,12 @@ void WorldSystem::load(const std::string& file)
 				UserError("<house> can only be used inside <IndoorWorld>");
 
 			world.indoorWidth = wxml->FloatAttribute("width");
-			world.indoorTex = Texture::loadTexture(wxml->Attribute("texture"));
+			world.indoorTexPath = wxml->StrAttribute("texture");
 		}
 
 		// weather tag
 		else if (tagName == "weather") {
-			setWeather(wxml->GetText());
+			world.weather = toWeather(wxml->GetText());
 		}
 
 		// link tags
@@ -323,7 +344,7 @@ void WorldSystem::load(const std::string& file)
 
 		// time setting
 		else if (tagName == "time") {
-            game::time::setTickCount(std::stoi(wxml->GetText()));
+            world.time = std::stoi(wxml->GetText());
         }
 
 		// custom entity tags
@@ -332,7 +353,7 @@ void WorldSystem::load(const std::string& file)
 			if (cxml != nullptr) {
 				DEBUG_printf("Using custom tag <%s>\n", tagName.c_str());
 
-				entity = game::entities.create();
+				entity = world.entities->entities.create();
 				auto abcd = cxml->FirstChildElement();
 
 				while (abcd) {
@@ -351,6 +372,12 @@ void WorldSystem::load(const std::string& file)
 						entity.assign<Position>(cdat[0], cdat[1]);
 					} else if (tname == "Visible") {
 						entity.assign<Visible>(abcd->FloatAttribute("value"));
+					} else if (tname == "Light") {
+						float r = 1.0f, g = 1.0f, b = 1.0f;
+						abcd->QueryFloatAttribute("red", &r);
+						abcd->QueryFloatAttribute("green", &g);
+						abcd->QueryFloatAttribute("blue", &b);
+						entity.assign<Light>(abcd->FloatAttribute("radius"), Color(r, g, b, 1.0f));
 					} else if (tname == "Sprite") {
 						auto sprite = entity.assign<Sprite>();
 						auto tex = abcd->Attribute("image");
@@ -363,7 +390,7 @@ void WorldSystem::load(const std::string& file)
 				}
 
 			} else {
-				UserError("Unknown tag <" + tagName + "> in file " + currentXMLFile);
+				UserError("Unknown tag <" + tagName + "> in file " + file);
 			}
 		}
 
@@ -375,9 +402,83 @@ void WorldSystem::load(const std::string& file)
 		wxml = wxml->NextSiblingElement();
 	}
 
+	return world;
+}
+
+std::future<WorldData2> WorldSystem::prebuild(const std::string& file)
+{
+	if (file.empty())
+		return std::future<WorldData2>();
+
+	return std::async(std::launch::async, &WorldSystem::build, file);
+}
+
+void WorldSystem::activate(WorldData2 w)
+{
+	auto ps = game::engine.getSystem<PlayerSystem>();
+	auto current = game::engine.getWorld();
+
+	// nothing refers to the incoming world's entities yet, so they can move
+	if (game::pools::needsCompaction(w.entities->entities))
+		w.entities = game::pools::compact(*w.entities);
+
+	// nobody's standing on the old world's grass once we've left it
+	releaseGrass();
+
+	// the player walks into the new world, leaving everything else behind;
+	// the old one stays until the switch so the render thread never sees it gone
+	entityx::Entity player, arrived;
+	if (current->entities.valid(ps->getPlayerId())) {
+		player = current->entities.get(ps->getPlayerId());
+		arrived = copyEntity(player, w.entities->entities);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock (worldMutex);
+		std::swap(world, w);
+		texturesOutdated = true;
+	}
+
+	weather = world.weather;
+	if (world.time >= 0)
+		game::time::setTickCount(world.time);
+
+	game::engine.activateWorld(world.entities);
+
+	if (arrived.valid()) {
+		ps->setPlayer(arrived);
+		player.destroy();
+	}
+
+	// the world we came from is kept as a neighbour, the one on the other side
+	// gets built in the background
+	if (w.entities && !w.xmlFile.empty() && w.xmlFile == world.toLeft) {
+		std::promise<WorldData2> p;
+		p.set_value(std::move(w));
+		worldLeft = p.get_future();
+		worldRight = prebuild(world.toRight);
+	} else if (w.entities && !w.xmlFile.empty() && w.xmlFile == world.toRight) {
+		std::promise<WorldData2> p;
+		p.set_value(std::move(w));
+		worldRight = p.get_future();
+		worldLeft = prebuild(world.toLeft);
+	} else {
+		worldLeft = prebuild(world.toLeft);
+		worldRight = prebuild(world.toRight);
+	}
+
 	game::events.emit<BGMToggleEvent>();
 }
 
+void WorldSystem::load(const std::string& file)
+{
+	// check for empty file name
+	if (file.empty())
+		return;
+
+	activate(build(file));
+}
+
 /*
 World *
 loadWorldFromXMLNoSave(std::string path) {
@@ -571,7 +672,8 @@ loadWorldFromXMLNoSave(std::string path) {
 }*/
 
 WorldSystem::WorldSystem(void)
-	: weather(WorldWeather::None), bgmObj(nullptr) {}
+	: weather(WorldWeather::None), bgmObj(nullptr), indoorTex(0), texturesOutdated(false), dirtVBO(0),
+	  grassVBO(0), grassTex(0), grassBlade(-1), layerVBO(0) {}
 
 WorldSystem::~WorldSystem(void)
 {
@@ -580,6 +682,332 @@ WorldSystem::~WorldSystem(void)
 		Mix_FreeMusic(bgmObj);
 }
 
+/**
+ * Packs a column's grass into a texel: the blade heights, then whether it's
+ * been pressed down.
+ */
+static void packGrass(const WorldData& wd, GLubyte *texel)
+{
+	texel[0] = static_cast<GLubyte>(std::clamp(wd.grassHeight[0] * GRASS_HEIGHT_SCALE, 0.0f, 255.0f));
+	texel[1] = static_cast<GLubyte>(std::clamp(wd.grassHeight[1] * GRASS_HEIGHT_SCALE, 0.0f, 255.0f));
+	texel[2] = wd.grassUnpressed ? 0 : 255;
+	texel[3] = 255;
+}
+
+void WorldSystem::resetTerrain(void)
+{
+	dirtyChunks.assign((world.data.size() + TERRAIN_CHUNK_COLUMNS - 1) / TERRAIN_CHUNK_COLUMNS, true);
+	grassChanged.clear();
+
+	if (dirtVBO == 0) {
+		glGenBuffers(1, &dirtVBO);
+		glGenBuffers(1, &grassVBO);
+		glGenTextures(1, &grassTex);
+		grassBlade = glGetAttribLocation(Render::grassShader.shader, "blade");
+	}
+
+	// chunks are filled in as they come into view
+	glBindBuffer(GL_ARRAY_BUFFER, dirtVBO);
+	glBufferData(GL_ARRAY_BUFFER, world.data.size() * DIRT_COLUMN_FLOATS * sizeof(GLfloat), nullptr, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, grassVBO);
+	glBufferData(GL_ARRAY_BUFFER, world.data.size() * GRASS_COLUMN_FLOATS * sizeof(GLfloat), nullptr, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// but the grass state goes up all at once
+	unsigned int rows = std::max((world.data.size() + GRASS_TEXTURE_WIDTH - 1) / GRASS_TEXTURE_WIDTH, static_cast<size_t>(1));
+	std::vector<GLubyte> texels (GRASS_TEXTURE_WIDTH * rows * 4, 0);
+	for (unsigned int i = 0; i < world.data.size(); i++)
+		packGrass(world.data[i], &texels[i * 4]);
+
+	grassTexSize = vec2(GRASS_TEXTURE_WIDTH, rows);
+
+	Render::state::bindTexture(grassTex);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, GRASS_TEXTURE_WIDTH, rows, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+}
+
+void WorldSystem::buildChunks(unsigned int cStart, unsigned int cEnd)
+{
+	const auto HLINE = game::HLINE;
+
+	std::vector<GLfloat> dirt, grass;
+	for (unsigned int c = cStart; c < cEnd; c++) {
+		if (!dirtyChunks[c])
+			continue;
+
+		unsigned int first = c * TERRAIN_CHUNK_COLUMNS;
+		unsigned int last = std::min(first + TERRAIN_CHUNK_COLUMNS, static_cast<unsigned int>(world.data.size()));
+
+		dirt.clear();
+		grass.clear();
+		for (unsigned int i = first; i < last; i++) {
+			// holes are drawn as a sliver just under the lowest ground
+			float gh = world.data[i].groundHeight;
+			bool hole = (gh <= 0);
+			if (hole)
+				gh = GROUND_HEIGHT_MINIMUM - 1;
+
+			float ty = static_cast<int>(gh / 64 + world.data[i].groundColor);
+			float x0 = world.startX + HLINES(i), x1 = x0 + HLINE, xm = x0 + HLINE / 2;
+			float top = gh - GRASS_HEIGHT;
+
+			GLfloat column[DIRT_COLUMN_FLOATS] = {
+				x0, top, -4.0f, 0, 0,
+				x1, top, -4.0f, 1, 0,
+				x1, 0,   -4.0f, 1, ty,
+
+				x1, 0,   -4.0f, 1, ty,
+				x0, 0,   -4.0f, 0, ty,
+				x0, top, -4.0f, 0, 0
+			};
+
+			dirt.insert(dirt.end(), std::begin(column), std::end(column));
+
+			// blade tops sit on the ground; the shader raises them. Holes get
+			// flat blades, which draw nothing
+			float col = i;
+			float b0 = hole ? 0 : 1, b1 = hole ? 0 : 2;
+			float gy = hole ? top : gh;
+
+			GLfloat blades[GRASS_COLUMN_FLOATS] = {
+				x0, gy,  -3, 0, 0, col, b0,
+				xm, gy,  -3, 1, 0, col, b0,
+				xm, top, -3, 1, 1, col, 0,
+
+				xm, top, -3, 1, 1, col, 0,
+				x0, top, -3, 0, 1, col, 0,
+				x0, gy,  -3, 0, 0, col, b0,
+
+				xm, gy,  -3, 0, 0, col, b1,
+				x1, gy,  -3, 1, 0, col, b1,
+				x1, top, -3, 1, 1, col, 0,
+
+				x1, top, -3, 1, 1, col, 0,
+				xm, top, -3, 0, 1, col, 0,
+				xm, gy,  -3, 0, 0, col, b1
+			};
+
+			grass.insert(grass.end(), std::begin(blades), std::end(blades));
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, dirtVBO);
+		glBufferSubData(GL_ARRAY_BUFFER, first * DIRT_COLUMN_FLOATS * sizeof(GLfloat),
+		                dirt.size() * sizeof(GLfloat), dirt.data());
+		glBindBuffer(GL_ARRAY_BUFFER, grassVBO);
+		glBufferSubData(GL_ARRAY_BUFFER, first * GRASS_COLUMN_FLOATS * sizeof(GLfloat),
+		                grass.size() * sizeof(GLfloat), grass.data());
+		dirtyChunks[c] = false;
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void WorldSystem::drawDirt(unsigned int first, unsigned int last)
+{
+	// drawn with the sprites, ahead of them; they've always been lit like the dirt
+	auto& commands = Render::commands();
+	static const GLfloat lightImpact = 0.45f;
+
+	commands.setUniform(RP_world, Render::worldShader, WU_light_impact, &lightImpact, 1);
+	commands.drawMesh(RP_world, Render::worldShader, dirtVBO, first * 6, (last - first) * 6,
+	                  bgTex.getTexture(), -4.0f);
+}
+
+void WorldSystem::drawGrass(unsigned int first, unsigned int last)
+{
+	GPU_PASS("grass");
+
+	auto& shader = Render::grassShader;
+
+	// send up the columns that have been stepped on or off of
+	if (!grassChanged.empty()) {
+		Render::state::bindTexture(grassTex);
+		for (auto i : grassChanged) {
+			GLubyte texel[4];
+			packGrass(world.data[i], texel);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, i % GRASS_TEXTURE_WIDTH, i / GRASS_TEXTURE_WIDTH, 1, 1,
+			                GL_RGBA, GL_UNSIGNED_BYTE, texel);
+		}
+		grassChanged.clear();
+	}
+
+	shader.use();
+	Render::state::uniform1i(shader.uniform[WU_texture], 0);
+	Render::state::uniform1i(shader.uniform[GU_grass], 1);
+	Render::state::uniform2f(shader.uniform[GU_grass_size], grassTexSize.x, grassTexSize.y);
+	Render::state::uniform1f(shader.uniform[GU_wind_time], game::time::getTickCount() / 20.0f);
+	Render::state::uniform4f(shader.uniform[WU_tex_color], 1.0, 1.0, 1.0, 1.0);
+	Render::state::uniform4f(shader.uniform[WU_ambient], ambient.red, ambient.green, ambient.blue, 1.0);
+	Render::state::uniform1f(shader.uniform[WU_light_impact], 1.0f);
+
+	Render::state::activeTexture(GL_TEXTURE1);
+	Render::state::bindTexture(grassTex);
+	Render::state::activeTexture(GL_TEXTURE0);
+
+	glBindBuffer(GL_ARRAY_BUFFER, grassVBO);
+	shader.enable();
+	Render::state::enableAttrib(grassBlade);
+
+	const auto stride = GRASS_VERTEX_FLOATS * sizeof(GLfloat);
+	glVertexAttribPointer(shader.coord, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(0));
+	glVertexAttribPointer(shader.tex, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(3 * sizeof(GLfloat)));
+	glVertexAttribPointer(grassBlade, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(5 * sizeof(GLfloat)));
+	glDrawArrays(GL_TRIANGLES, first * 12, (last - first) * 12);
+
+	Render::state::disableAttrib(grassBlade);
+	shader.disable();
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	shader.unuse();
+}
+
+void WorldSystem::pressGrass(unsigned int column, bool pressed)
+{
+	std::lock_guard<std::mutex> lock (worldMutex);
+
+	if (column >= world.data.size() || world.data[column].grassUnpressed != pressed)
+		return;
+
+	world.data[column].grassUnpressed = !pressed;
+	grassChanged.push_back(column);
+}
+
+void WorldSystem::stepGrass(entityx::Entity::Id id, int column)
+{
+	auto found = grassPressing.find(id);
+	if (found != grassPressing.end()) {
+		if (static_cast<int>(found->second) == column)
+			return;
+
+		// step off the old column, letting it up if nobody else is on it
+		if (--grassWeight[found->second] == 0) {
+			grassWeight.erase(found->second);
+			pressGrass(found->second, false);
+		}
+
+		grassPressing.erase(found);
+	}
+
+	if (column < 0)
+		return;
+
+	grassPressing.emplace(id, column);
+	if (grassWeight[column]++ == 0)
+		pressGrass(column, true);
+}
+
+void WorldSystem::releaseGrass(void)
+{
+	for (const auto& w : grassWeight)
+		pressGrass(w.first, false);
+
+	grassPressing.clear();
+	grassWeight.clear();
+}
+
+void WorldSystem::buildLayers(void)
+{
+	const auto SCREEN_WIDTH = game::SCREEN_WIDTH;
+
+	// the quads reach a screen past each end of the world, so scrolling never
+	// shows their edges
+	float x0 = world.startX - SCREEN_WIDTH, x1 = -world.startX + SCREEN_WIDTH;
+
+	std::vector<GLfloat> verts;
+	auto quad = [this, &verts](float l, float r, float z, float y1, float s0, float s1) {
+		layerBounds[verts.size() / 30] = std::make_pair(vec2(l, GROUND_HEIGHT_MINIMUM),
+		                                                vec2(r - l, y1 - GROUND_HEIGHT_MINIMUM));
+
+		GLfloat q[] = {
+			l, GROUND_HEIGHT_MINIMUM, z, s0, 0,
+			r, GROUND_HEIGHT_MINIMUM, z, s1, 0,
+			r, y1,                    z, s1, 1,
+
+			r, y1,                    z, s1, 1,
+			l, y1,                    z, s0, 1,
+			l, GROUND_HEIGHT_MINIMUM, z, s0, 0
+		};
+		verts.insert(verts.end(), std::begin(q), std::end(q));
+	};
+
+	for (unsigned int i = 0; i < WORLD_LAYER_COUNT; i++) {
+		// layers are the third through seventh style images
+		layerDims[i] = Texture::imageDim(bgTex.getTexturePath(i + 2));
+
+		bgTex(i + 2);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+		const auto& dim = layerDims[i];
+		float z = (i == 0) ? 8.0f : 7 - ((i - 1) * .1f);
+		quad(x0, x1, z, GROUND_HEIGHT_MINIMUM + dim.y,
+		     (x0 - world.startX) / dim.x, (x1 - world.startX) / dim.x);
+	}
+
+	// indoors, the closest layer is a single unscrolled image the size of the house
+	const auto& dim = layerDims[WORLD_LAYER_COUNT - 1];
+	quad(world.startX, world.startX + world.indoorWidth, 7 - .3f, GROUND_HEIGHT_MINIMUM + dim.y, 0, 1);
+
+	if (layerVBO == 0)
+		glGenBuffers(1, &layerVBO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, layerVBO);
+	glBufferData(GL_ARRAY_BUFFER, verts.size() * sizeof(GLfloat), verts.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void WorldSystem::drawLayers(void)
+{
+	GPU_PASS("layers");
+
+	// how far each layer moves with the camera, furthest first
+	static const float parallax[WORLD_LAYER_COUNT] = {
+		0.85f, bgDraw[0][2], bgDraw[1][2], bgDraw[2][2], bgDraw[3][2]
+	};
+
+	Render::worldShader.use();
+	glBindBuffer(GL_ARRAY_BUFFER, layerVBO);
+	Render::worldShader.enable();
+
+	glVertexAttribPointer(Render::worldShader.coord, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), reinterpret_cast<void *>(0));
+	glVertexAttribPointer(Render::worldShader.tex, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), reinterpret_cast<void *>(3 * sizeof(GLfloat)));
+
+	auto view = Render::getView();
+
+	for (unsigned int i = 0; i < WORLD_LAYER_COUNT; i++) {
+		bool indoor = world.indoor && i == WORLD_LAYER_COUNT - 1;
+
+		// the quads stay put while their textures scroll, so test them unshifted
+		const auto& bounds = layerBounds[indoor ? WORLD_LAYER_COUNT : i];
+		if (!Render::cull::test(CK_layers, view, bounds.first, bounds.second))
+			continue;
+
+		bgTex(i + 2);
+		Render::state::uniform1f(Render::worldShader.uniform[WU_light_impact], (i == 0) ? 0.01f : 0.075f + (0.2f * (i - 1)));
+
+		if (indoor) {
+			Render::state::bindTexture(indoorTex);
+			Render::state::uniform2f(Render::worldShader.uniform[WU_tex_offset], 0, 0);
+			glDrawArrays(GL_TRIANGLES, WORLD_LAYER_COUNT * 6, 6);
+		} else {
+			// moving the layer along with the camera is scrolling its texture back
+			Render::state::uniform2f(Render::worldShader.uniform[WU_tex_offset], -offset.x * parallax[i] / layerDims[i].x, 0);
+			glDrawArrays(GL_TRIANGLES, i * 6, 6);
+		}
+	}
+
+	Render::state::uniform2f(Render::worldShader.uniform[WU_tex_offset], 0, 0);
+
+	// the ground's textures follow the last layer's, whether or not it was drawn
+	bgTex(WORLD_LAYER_COUNT + 1);
+
+	Render::worldShader.disable();
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
 void WorldSystem::render(void)
 {
 	const auto SCREEN_WIDTH = game::SCREEN_WIDTH;
@@ -592,8 +1020,24 @@ void WorldSystem::render(void)
 
 	int iStart, iEnd, pOffset;
 
-    // world width in pixels
-	int width = world.data.size() * HLINE;
+	std::lock_guard<std::mutex> lock (worldMutex);
+
+	// textures can only be made here, on the render thread
+	if (texturesOutdated) {
+		bgTex = TextureIterator(world.sTexLoc);
+		indoorTex = world.indoorTexPath.empty() ? 0 : Texture::loadTexture(world.indoorTexPath);
+		resetTerrain();
+		buildLayers();
+
+		// the sky scrolls
+		for (int i = 0; i < 2; i++) {
+			bgTex(i);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		}
+
+		texturesOutdated = false;
+	}
 
     // used for alpha values of background textures
     int alpha;
@@ -661,14 +1105,6 @@ void WorldSystem::render(void)
 									 0.0f,  bottomS,
 									 0.0f,  bottomS};
 
-   	vec2 bg_tex_coord[] = { vec2(0.0f, 0.0f),
-                            vec2(1.0f, 0.0f),
-                            vec2(1.0f, 1.0f),
-
-                            vec2(1.0f, 1.0f),
-                            vec2(0.0f, 1.0f),
-                            vec2(0.0f, 0.0f)};
-
     GLfloat back_tex_coord[] = {offset.x - backgroundOffset.x - 5, offset.y - backgroundOffset.y, 9.9f,
                                 offset.x + backgroundOffset.x + 5, offset.y - backgroundOffset.y, 9.9f,
                                 offset.x + backgroundOffset.x + 5, offset.y + backgroundOffset.y, 9.9f,
@@ -687,26 +1123,23 @@ void WorldSystem::render(void)
 
 	// rendering!!
 
-    glActiveTexture(GL_TEXTURE0);
-    glUniform1i(Render::worldShader.uniform[WU_texture], 0);
+    Render::state::activeTexture(GL_TEXTURE0);
 
 	Render::worldShader.use();
-	glUniform1f(Render::worldShader.uniform[WU_light_impact], 0.0f);
-	glUniform4f(Render::worldShader.uniform[WU_ambient], 1.0, 1.0, 1.0, 1.0);
+	Render::state::uniform1i(Render::worldShader.uniform[WU_texture], 0);
+	Render::state::uniform1f(Render::worldShader.uniform[WU_light_impact], 0.0f);
+	Render::state::uniform4f(Render::worldShader.uniform[WU_ambient], 1.0, 1.0, 1.0, 1.0);
 
     Render::worldShader.enable();
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
     bgTex(0);
-	glUniform4f(Render::worldShader.uniform[WU_tex_color], 1.0, 1.0, 1.0, 1.0);
+	Render::state::uniform4f(Render::worldShader.uniform[WU_tex_color], 1.0, 1.0, 1.0, 1.0);
 
 
 	makeWorldDrawingSimplerEvenThoughAndyDoesntThinkWeCanMakeItIntoFunctions(0, back_tex_coord, scrolling_tex_coord, 6);
 
 	bgTex++;
-	glUniform4f(Render::worldShader.uniform[WU_tex_color], 1.0, 1.0, 1.0, 1.3 - static_cast<float>(alpha)/255.0f);
+	Render::state::uniform4f(Render::worldShader.uniform[WU_tex_color], 1.0, 1.0, 1.0, 1.3 - static_cast<float>(alpha)/255.0f);
 
 	makeWorldDrawingSimplerEvenThoughAndyDoesntThinkWeCanMakeItIntoFunctions(0, fron_tex_coord, tex_coord, 6);
 
@@ -733,98 +1166,19 @@ void WorldSystem::render(void)
 			std::memcpy(si, data, sizeof(float) * 30);
 			si += 30;
 		}
-		glBindTexture(GL_TEXTURE_2D, starTex);
-		glUniform4f(Render::worldShader.uniform[WU_tex_color], 1.0, 1.0, 1.0, 1.3 - static_cast<float>(alpha)/255.0f);
+		Render::state::bindTexture(starTex);
+		Render::state::uniform4f(Render::worldShader.uniform[WU_tex_color], 1.0, 1.0, 1.0, 1.3 - static_cast<float>(alpha)/255.0f);
 
 		makeWorldDrawingSimplerEvenThoughAndyDoesntThinkWeCanMakeItIntoFunctions(5 * sizeof(GLfloat), &star_coord[0], &star_coord[3], star.size() * 6);
 	}*/
 
 	Render::worldShader.disable();
 
-	glUniform4f(Render::worldShader.uniform[WU_tex_color], 1.0, 1.0, 1.0, 1.0);
-	glUniform4f(Render::worldShader.uniform[WU_ambient], ambient.red, ambient.green, ambient.blue, 1.0);
-
-	Render::worldShader.unuse();
-
-    std::vector<vec3> bg_items;
-	std::vector<vec2> bg_tex;
-
-	bgTex++;
-	vec2 mountainDim = bgTex.getTextureDim();
-    auto xcoord = width / 2 * -1 + offset.x * 0.85f;
-	for (int i = 0; i <= width / mountainDim.x; i++) {
-        bg_items.emplace_back(mountainDim.x * i       + xcoord, GROUND_HEIGHT_MINIMUM, 				 8.0f);
-        bg_items.emplace_back(mountainDim.x * (i + 1) + xcoord, GROUND_HEIGHT_MINIMUM, 				 8.0f);
-        bg_items.emplace_back(mountainDim.x * (i + 1) + xcoord, GROUND_HEIGHT_MINIMUM + mountainDim.y, 8.0f);
-
-        bg_items.emplace_back(mountainDim.x * (i + 1) + xcoord, GROUND_HEIGHT_MINIMUM + mountainDim.y, 8.0f);
-        bg_items.emplace_back(mountainDim.x * i       + xcoord, GROUND_HEIGHT_MINIMUM + mountainDim.y, 8.0f);
-        bg_items.emplace_back(mountainDim.x * i       + xcoord, GROUND_HEIGHT_MINIMUM, 				 8.0f);
-	}
-
-    for (uint i = 0; i < bg_items.size()/6; i++) {
-        for (auto &v : bg_tex_coord)
-            bg_tex.push_back(v);
-    }
+	Render::state::uniform4f(Render::worldShader.uniform[WU_tex_color], 1.0, 1.0, 1.0, 1.0);
+	Render::state::uniform4f(Render::worldShader.uniform[WU_ambient], ambient.red, ambient.green, ambient.blue, 1.0);
 
-    Render::worldShader.use();
-	glUniform1f(Render::worldShader.uniform[WU_light_impact], 0.01);
-
-	makeWorldDrawingSimplerEvenThoughAndyDoesntThinkWeCanMakeItIntoFunctions_JustDrawThis(0, bg_items.data(), bg_tex.data(), bg_items.size());
-
-    Render::worldShader.unuse();
-
-	// draw the remaining layers
-	for (unsigned int i = 0; i < 4; i++) {
-		bgTex++;
-		auto dim = bgTex.getTextureDim();
-		auto xcoord = offset.x * bgDraw[i][2];
-
-		bg_items.clear();
-		bg_tex.clear();
-
-		if (world.indoor && i == 3) {
-			glBindTexture(GL_TEXTURE_2D, world.indoorTex);
-
-			const auto& startx = world.startX;
-
-			bg_items.emplace_back(startx, GROUND_HEIGHT_MINIMUM, 7-(i*.1));
-	        bg_items.emplace_back(startx + world.indoorWidth, GROUND_HEIGHT_MINIMUM,	7-(i*.1));
-	        bg_items.emplace_back(startx + world.indoorWidth, GROUND_HEIGHT_MINIMUM + dim.y, 7-(i*.1));
-
-	        bg_items.emplace_back(startx + world.indoorWidth, GROUND_HEIGHT_MINIMUM + dim.y, 7-(i*.1));
-	        bg_items.emplace_back(startx, GROUND_HEIGHT_MINIMUM + dim.y, 7-(i*.1));
-	        bg_items.emplace_back(startx, GROUND_HEIGHT_MINIMUM,	7-(i*.1));
-		} else {
-			for (int j = world.startX; j <= -world.startX; j += dim.x) {
-	            bg_items.emplace_back(j         + xcoord, GROUND_HEIGHT_MINIMUM, 		7-(i*.1));
-	            bg_items.emplace_back(j + dim.x + xcoord, GROUND_HEIGHT_MINIMUM, 		7-(i*.1));
-	            bg_items.emplace_back(j + dim.x + xcoord, GROUND_HEIGHT_MINIMUM + dim.y, 7-(i*.1));
-
-	            bg_items.emplace_back(j + dim.x + xcoord, GROUND_HEIGHT_MINIMUM + dim.y, 7-(i*.1));
-	            bg_items.emplace_back(j         + xcoord, GROUND_HEIGHT_MINIMUM + dim.y, 7-(i*.1));
-	            bg_items.emplace_back(j         + xcoord, GROUND_HEIGHT_MINIMUM, 		7-(i*.1));
-			}
-		}
-
-   	    for (uint i = 0; i < bg_items.size()/6; i++) {
-			for (auto &v : bg_tex_coord)
-				bg_tex.push_back(v);
-		}
-
-        Render::worldShader.use();
-		glUniform1f(Render::worldShader.uniform[WU_light_impact], 0.075f + (0.2f*i));
-
-	    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-		makeWorldDrawingSimplerEvenThoughAndyDoesntThinkWeCanMakeItIntoFunctions_JustDrawThis(0, bg_items.data(), &bg_tex[0], bg_items.size());
-
-        Render::worldShader.unuse();
-	}
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// draw the parallax layers, each one quad scrolled by its texture coordinates
+	drawLayers();
 
     // get the line that the player is currently standing on
     pOffset = (offset.x /*+ player->width / 2*/ - world.startX) / HLINE;
@@ -832,124 +1186,32 @@ void WorldSystem::render(void)
     // only draw world within player vision
     iStart = std::clamp(static_cast<int>(pOffset - (SCREEN_WIDTH / 2 / HLINE) - GROUND_HILLINESS),
 	                    0, static_cast<int>(world.data.size()));
-	iEnd = std::clamp(static_cast<int>(pOffset + (SCREEN_WIDTH / 2 / HLINE)),
-                      0, static_cast<int>(world.data.size())) + 1;
-
-    // draw the dirt
-    bgTex++;
-    std::vector<std::pair<vec2,vec3>> c;
-
-    for (int i = iStart; i < iEnd; i++) {
-        if (world.data[i].groundHeight <= 0) { // TODO holes (andy)
-            world.data[i].groundHeight = GROUND_HEIGHT_MINIMUM - 1;
-            glColor4ub(0, 0, 0, 255);
-        } else {
-            safeSetColorA(150, 150, 150, 255);
-        }
-
-        int ty = world.data[i].groundHeight / 64 + world.data[i].groundColor;
-
-		c.push_back(std::make_pair(vec2(0, 0), vec3(world.startX + HLINES(i),         world.data[i].groundHeight - GRASS_HEIGHT, -4.0f)));
-        c.push_back(std::make_pair(vec2(1, 0), vec3(world.startX + HLINES(i) + HLINE, world.data[i].groundHeight - GRASS_HEIGHT, -4.0f)));
-        c.push_back(std::make_pair(vec2(1, ty),vec3(world.startX + HLINES(i) + HLINE, 0,                                         -4.0f)));
-
-        c.push_back(std::make_pair(vec2(1, ty),vec3(world.startX + HLINES(i) + HLINE, 0,                                         -4.0f)));
-        c.push_back(std::make_pair(vec2(0, ty),vec3(world.startX + HLINES(i),         0,                                         -4.0f)));
-        c.push_back(std::make_pair(vec2(0, 0), vec3(world.startX + HLINES(i),         world.data[i].groundHeight - GRASS_HEIGHT, -4.0f)));
-
-        if (world.data[i].groundHeight == GROUND_HEIGHT_MINIMUM - 1)
-            world.data[i].groundHeight = 0;
-    }
-
-    std::vector<GLfloat> dirtc;
-    std::vector<GLfloat> dirtt;
+	iEnd = std::clamp(static_cast<int>(pOffset + (SCREEN_WIDTH / 2 / HLINE)) + 1,
+                      0, static_cast<int>(world.data.size()));
 
-    for (auto &v : c) {
-        dirtc.push_back(v.second.x);
-        dirtc.push_back(v.second.y);
-        dirtc.push_back(v.second.z);
+	// build any ground that's come into view out of date, then draw it
+	unsigned int cStart = iStart / TERRAIN_CHUNK_COLUMNS;
+	unsigned int cEnd = std::min((iEnd + TERRAIN_CHUNK_COLUMNS - 1) / TERRAIN_CHUNK_COLUMNS,
+	                             static_cast<unsigned int>(dirtyChunks.size()));
+	buildChunks(cStart, cEnd);
 
-        dirtt.push_back(v.first.x);
-        dirtt.push_back(v.first.y);
-    }
+	unsigned int first = std::min(cStart * TERRAIN_CHUNK_COLUMNS, static_cast<unsigned int>(world.data.size()));
+	unsigned int last = std::min(cEnd * TERRAIN_CHUNK_COLUMNS, static_cast<unsigned int>(world.data.size()));
 
-    Render::worldShader.use();
-	glUniform1f(Render::worldShader.uniform[WU_light_impact], 0.45f);
-
-    Render::worldShader.enable();
-
-    glVertexAttribPointer(Render::worldShader.coord, 3, GL_FLOAT, GL_FALSE, 0, &dirtc[0]);
-    glVertexAttribPointer(Render::worldShader.tex, 2, GL_FLOAT, GL_FALSE, 0, &dirtt[0]);
-    glDrawArrays(GL_TRIANGLES, 0 , c.size());
-
-    Render::worldShader.disable();
-	Render::worldShader.unuse();
+	// draw the dirt
+	bgTex++;
+	if (first < last)
+		drawDirt(first, last);
 
 	if (!world.indoor) {
 		bgTex++;
-	    safeSetColorA(255, 255, 255, 255);
-
-	    c.clear();
-	    std::vector<GLfloat> grassc;
-	    std::vector<GLfloat> grasst;
-
-		for (int i = iStart; i < iEnd; i++) {
-        	auto wd = world.data[i];
-	        auto gh = wd.grassHeight;
-
-			// flatten the grass if the player is standing on it.
-			if (!wd.grassUnpressed) {
-				gh[0] /= 4;
-				gh[1] /= 4;
-			}
-
-			// actually draw the grass.
-	        if (wd.groundHeight) {
-				const auto& worldStart = world.startX;
-
-	            c.push_back(std::make_pair(vec2(0, 0),vec3(worldStart + HLINES(i)            , wd.groundHeight + gh[0], 		-3)));
-	            c.push_back(std::make_pair(vec2(1, 0),vec3(worldStart + HLINES(i) + HLINE / 2, wd.groundHeight + gh[0], 		-3)));
-	            c.push_back(std::make_pair(vec2(1, 1),vec3(worldStart + HLINES(i) + HLINE / 2, wd.groundHeight - GRASS_HEIGHT, 	-3)));
-
-    	        c.push_back(std::make_pair(vec2(1, 1),vec3(worldStart + HLINES(i) + HLINE / 2, wd.groundHeight - GRASS_HEIGHT,	-3)));
-	            c.push_back(std::make_pair(vec2(0, 1),vec3(worldStart + HLINES(i)		     , wd.groundHeight - GRASS_HEIGHT,	-3)));
-	            c.push_back(std::make_pair(vec2(0, 0),vec3(worldStart + HLINES(i)            , wd.groundHeight + gh[0],			-3)));
-
-	            c.push_back(std::make_pair(vec2(0, 0),vec3(worldStart + HLINES(i) + HLINE / 2, wd.groundHeight + gh[1],			-3)));
-	            c.push_back(std::make_pair(vec2(1, 0),vec3(worldStart + HLINES(i) + HLINE    , wd.groundHeight + gh[1],			-3)));
-	            c.push_back(std::make_pair(vec2(1, 1),vec3(worldStart + HLINES(i) + HLINE    , wd.groundHeight - GRASS_HEIGHT,	-3)));
-
-    	        c.push_back(std::make_pair(vec2(1, 1),vec3(worldStart + HLINES(i) + HLINE    , wd.groundHeight - GRASS_HEIGHT,	-3)));
-	            c.push_back(std::make_pair(vec2(0, 1),vec3(worldStart + HLINES(i) + HLINE / 2, wd.groundHeight - GRASS_HEIGHT,	-3)));
-	            c.push_back(std::make_pair(vec2(0, 0),vec3(worldStart + HLINES(i) + HLINE / 2, wd.groundHeight + gh[1],			-3)));
-	        }
-		}
-
-	    for (auto &v : c) {
-	        grassc.push_back(v.second.x);
-	        grassc.push_back(v.second.y);
-	        grassc.push_back(v.second.z);
-
-        	grasst.push_back(v.first.x);
-    	    grasst.push_back(v.first.y);
-	    }
-
-	    Render::worldShader.use();
-		glUniform1f(Render::worldShader.uniform[WU_light_impact], 1.0f);
-
-	    Render::worldShader.enable();
-
-	    glVertexAttribPointer(Render::worldShader.coord, 3, GL_FLOAT, GL_FALSE, 0, &grassc[0]);
-	    glVertexAttribPointer(Render::worldShader.tex, 2, GL_FLOAT, GL_FALSE, 0, &grasst[0]);
-	    glDrawArrays(GL_TRIANGLES, 0 , c.size());
-
-    	Render::worldShader.disable();
-		Render::worldShader.unuse();
+		if (first < last)
+			drawGrass(first, last);
 	} else {
 		Render::useShader(&Render::worldShader);
 		Render::worldShader.use();
 		static const GLuint rug = Texture::genColor(Color {255, 0, 0});
-		glBindTexture(GL_TEXTURE_2D, rug);
+		Render::state::bindTexture(rug);
 		vec2 ll = vec2 {world.startX, GROUND_HEIGHT_MINIMUM};
 		Render::drawRect(ll, vec2 {ll.x + world.indoorWidth, ll.y + 4}, -3);
 		Render::worldShader.unuse();
@@ -972,16 +1234,19 @@ void WorldSystem::receive(const BGMToggleEvent &bte)
 	}
 }
 
-void WorldSystem::setWeather(const std::string &s)
+WorldWeather WorldSystem::toWeather(const std::string &s)
 {
 	for (unsigned int i = 3; i--;) {
-		if (WorldWeatherString[i] == s) {
-			weather = static_cast<WorldWeather>(i);
-			return;
-		}
+		if (WorldWeatherString[i] == s)
+			return static_cast<WorldWeather>(i);
 	}
 
-	weather = WorldWeather::None;
+	return WorldWeather::None;
+}
+
+void WorldSystem::setWeather(const std::string &s)
+{
+	weather = toWeather(s);
 }
 
 void WorldSystem::update(entityx::EntityManager &en, entityx::EventManager &ev, entityx::TimeDelta dt)
@@ -1000,9 +1265,10 @@ void WorldSystem::update(entityx::EntityManager &en, entityx::EventManager &ev,
 
 void WorldSystem::detect(entityx::TimeDelta dt)
 {
-	game::entities.each<Position, Direction, Solid>(
-	    [&](entityx::Entity e, Position &loc, Direction &vel, Solid &dim) {
-		(void)e;
+	game::engine.getSystem<ActivitySystem>()->each<Position, Direction, Solid>(dt,
+	    [&](entityx::Entity e, entityx::TimeDelta dt, Position &loc, Direction &vel, Solid &dim) {
+		auto old = loc;
+		bool grounded = false;
 
 		//if (health.health <= 0)
 		//	UserError("die mofo");
@@ -1023,7 +1289,7 @@ void WorldSystem::detect(entityx::TimeDelta dt)
 			} else {
 				loc.y = data[line].groundHeight - 0.001f * dt;
 				vel.y = 0;
-				// TODO ground flag
+				grounded = true;
 			}
 		}
 
@@ -1040,7 +1306,34 @@ void WorldSystem::detect(entityx::TimeDelta dt)
 			vel.x = 0;
 			loc.x = -((int)world.startX) - dim.width - game::HLINE;
 		}
+
+		if (loc.x != old.x || loc.y != old.y)
+			Dirty<Position>::touch(e);
+
+		// whatever's standing on the ground flattens the grass under it
+		stepGrass(e.id(), grounded ? line : -1);
 	});
+
+	// entities that were destroyed while standing get off the grass
+	auto& en = game::engine.getWorld()->entities;
+	for (auto it = grassPressing.begin(); it != grassPressing.end();) {
+		auto next = std::next(it);
+		if (!en.valid(it->first))
+			stepGrass(it->first, -1);
+		it = next;
+	}
+}
+
+// takes the neighbour built in the background, or builds it now if it isn't there
+static WorldData2 takeNeighbour(std::future<WorldData2>& f, const std::string& file)
+{
+	if (f.valid()) {
+		auto w = f.get();
+		if (w.xmlFile == file)
+			return w;
+	}
+
+	return WorldSystem::build(file);
 }
 
 void WorldSystem::goWorldRight(Position& p)
@@ -1048,9 +1341,9 @@ void WorldSystem::goWorldRight(Position& p)
 	if (!(world.toRight.empty()) && (p.x > world.startX * -1 - HLINES(10))) {
 		ui::toggleBlack();
 		ui::waitForCover();
-		auto file = world.toRight;
-		load(file);
-		p.x = world.startX + HLINES(15);
+		activate(takeNeighbour(worldRight, world.toRight));
+		auto player = game::engine.getWorld()->entities.get(game::engine.getSystem<PlayerSystem>()->getPlayerId());
+		game::write<Position>(player).x = world.startX + HLINES(15);
 		ui::toggleBlack();
 	}
 }
@@ -1060,9 +1353,9 @@ void WorldSystem::goWorldLeft(Position& p)
 	if (!(world.toLeft.empty()) && (p.x < world.startX + HLINES(10))) {
 		ui::toggleBlack();
 		ui::waitForCover();
-		auto file = world.toLeft;
-		load(file);
-		p.x = world.startX * -1 - HLINES(15);
+		activate(takeNeighbour(worldLeft, world.toLeft));
+		auto player = game::engine.getWorld()->entities.get(game::engine.getSystem<PlayerSystem>()->getPlayerId());
+		game::write<Position>(player).x = world.startX * -1 - HLINES(15);
 		ui::toggleBlack();
 	}
 }